@@ -0,0 +1,78 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+
+void *
+_di_malloc(const struct di_allocator *allocator, size_t size)
+{
+	void *ptr;
+
+	if (!allocator)
+		return malloc(size);
+
+	ptr = allocator->malloc(size, allocator->user_data);
+	if (!ptr)
+		errno = ENOMEM;
+	return ptr;
+}
+
+void *
+_di_calloc(const struct di_allocator *allocator, size_t nmemb, size_t size)
+{
+	void *ptr;
+
+	if (!allocator)
+		return calloc(nmemb, size);
+
+	if (allocator->calloc) {
+		ptr = allocator->calloc(nmemb, size, allocator->user_data);
+		if (!ptr)
+			errno = ENOMEM;
+		return ptr;
+	}
+
+	if (size != 0 && nmemb > SIZE_MAX / size) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	ptr = _di_malloc(allocator, nmemb * size);
+	if (ptr)
+		memset(ptr, 0, nmemb * size);
+	return ptr;
+}
+
+void
+_di_free(const struct di_allocator *allocator, void *ptr)
+{
+	if (!allocator) {
+		free(ptr);
+		return;
+	}
+
+	if (ptr)
+		allocator->free(ptr, allocator->user_data);
+}
+
+void *
+_di_realloc(const struct di_allocator *allocator, void *ptr,
+	    size_t old_size, size_t new_size)
+{
+	void *new_ptr;
+
+	if (!allocator)
+		return realloc(ptr, new_size);
+
+	new_ptr = _di_malloc(allocator, new_size);
+	if (!new_ptr)
+		return NULL;
+
+	if (ptr) {
+		memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+		_di_free(allocator, ptr);
+	}
+	return new_ptr;
+}
@@ -0,0 +1,196 @@
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "arena.h"
+
+#define ARENA_ALIGN _Alignof(max_align_t)
+
+struct di_arena_chunk {
+	struct di_arena_chunk *next;
+	size_t size, used;
+	_Alignas(max_align_t) unsigned char data[];
+};
+
+static size_t
+align_size(size_t size)
+{
+	return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+void
+_di_arena_init(struct di_arena *arena, size_t chunk_size,
+	       const struct di_allocator *allocator)
+{
+	*arena = (struct di_arena) {
+		.chunk_size = align_size(chunk_size),
+		.allocator = allocator,
+	};
+}
+
+bool
+_di_arena_init_buffer(struct di_arena *arena, void *buf, size_t size)
+{
+	struct di_arena_chunk *chunk;
+	uintptr_t addr, aligned;
+
+	addr = (uintptr_t) buf;
+	aligned = (addr + ARENA_ALIGN - 1) & ~(uintptr_t) (ARENA_ALIGN - 1);
+	if (size < aligned - addr + sizeof(*chunk))
+		return false;
+	size -= aligned - addr + sizeof(*chunk);
+
+	chunk = (struct di_arena_chunk *) aligned;
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+
+	*arena = (struct di_arena) {
+		.chunks = chunk,
+		.fixed = true,
+	};
+	return true;
+}
+
+void
+_di_arena_set_chunk_size(struct di_arena *arena, size_t chunk_size)
+{
+	arena->chunk_size = align_size(chunk_size);
+}
+
+size_t
+_di_arena_get_alloc_size(size_t size)
+{
+	return align_size(size);
+}
+
+size_t
+_di_arena_get_buffer_size(size_t alloc_size)
+{
+	/* Worst case for the alignment of the caller-provided buffer */
+	return ARENA_ALIGN - 1 + sizeof(struct di_arena_chunk) + alloc_size;
+}
+
+static struct di_arena_chunk *
+add_chunk(struct di_arena *arena, size_t min_size)
+{
+	struct di_arena_chunk *chunk;
+	size_t size;
+
+	size = arena->chunk_size;
+	if (size < min_size)
+		size = min_size;
+
+	chunk = _di_malloc(arena->allocator, sizeof(*chunk) + size);
+	if (!chunk)
+		return NULL;
+
+	chunk->next = arena->chunks;
+	chunk->size = size;
+	chunk->used = 0;
+	arena->chunks = chunk;
+
+	/* Grow geometrically so that large blobs need few chunks */
+	arena->chunk_size = size * 2;
+	return chunk;
+}
+
+void *
+_di_arena_alloc(struct di_arena *arena, size_t size)
+{
+	struct di_arena_chunk *chunk;
+	void *ptr;
+
+	if (size > SIZE_MAX - ARENA_ALIGN) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	size = align_size(size);
+
+	chunk = arena->chunks;
+	if (!chunk || chunk->size - chunk->used < size) {
+		if (arena->fixed) {
+			errno = ENOMEM;
+			return NULL;
+		}
+		chunk = add_chunk(arena, size);
+		if (!chunk)
+			return NULL;
+	}
+
+	ptr = &chunk->data[chunk->used];
+	chunk->used += size;
+	memset(ptr, 0, size);
+	return ptr;
+}
+
+size_t
+_di_arena_get_used(const struct di_arena *arena)
+{
+	const struct di_arena_chunk *chunk;
+	size_t used;
+
+	used = 0;
+	for (chunk = arena->chunks; chunk; chunk = chunk->next)
+		used += chunk->used;
+
+	return used;
+}
+
+size_t
+_di_arena_get_reserved(const struct di_arena *arena)
+{
+	const struct di_arena_chunk *chunk;
+	size_t reserved;
+
+	reserved = 0;
+	for (chunk = arena->chunks; chunk; chunk = chunk->next)
+		reserved += sizeof(*chunk) + chunk->size;
+
+	return reserved;
+}
+
+void
+_di_arena_reset(struct di_arena *arena)
+{
+	struct di_arena_chunk *chunk, *next;
+	size_t size;
+
+	chunk = arena->chunks;
+	if (!chunk)
+		return;
+
+	if (arena->fixed || !chunk->next) {
+		chunk->used = 0;
+		return;
+	}
+
+	size = 0;
+	while (chunk) {
+		next = chunk->next;
+		size += chunk->size;
+		_di_free(arena->allocator, chunk);
+		chunk = next;
+	}
+
+	arena->chunks = NULL;
+	arena->chunk_size = size;
+}
+
+void
+_di_arena_finish(struct di_arena *arena)
+{
+	struct di_arena_chunk *chunk, *next;
+
+	if (arena->fixed)
+		return; /* The buffer belongs to the caller */
+
+	/* The arena struct may live in one of its own chunks */
+	chunk = arena->chunks;
+	while (chunk) {
+		next = chunk->next;
+		_di_free(arena->allocator, chunk);
+		chunk = next;
+	}
+}
@@ -20,49 +20,79 @@
 #define CTA_DTD_END 127
 
 static void
-add_failure(struct di_edid_cta *cta, const char fmt[], ...)
+emit_failure(struct di_edid_cta *cta, enum di_failure_code code,
+	     uintmax_t arg0, uintmax_t arg1, uintmax_t arg2)
 {
-	va_list args;
+	const uintmax_t args[DI_LOG_MAX_ARGS] = { arg0, arg1, arg2 };
 
-	va_start(args, fmt);
-	_di_logger_va_add_failure(cta->logger, fmt, args);
-	va_end(args);
+	if (!cta->logger) {
+		return;
+	}
+
+	_di_logger_add_failure(cta->logger, code, args);
 }
 
 static void
-add_failure_until(struct di_edid_cta *cta, int revision, const char fmt[], ...)
+emit_failure_until(struct di_edid_cta *cta, int revision,
+		   enum di_failure_code code,
+		   uintmax_t arg0, uintmax_t arg1, uintmax_t arg2)
 {
-	va_list args;
-
 	if (cta->revision > revision) {
 		return;
 	}
 
-	va_start(args, fmt);
-	_di_logger_va_add_failure(cta->logger, fmt, args);
-	va_end(args);
+	emit_failure(cta, code, arg0, arg1, arg2);
 }
 
+#define add_failure(cta, ...) \
+	add_failure_args(cta, __VA_ARGS__, 0, 0, 0, 0)
+
+#define add_failure_args(cta, code, arg0, arg1, arg2, ...) \
+	do { \
+		if (DI_FAILURE_ENABLED(code)) \
+			emit_failure(cta, code, arg0, arg1, arg2); \
+	} while (0)
+
+#define add_failure_until(cta, revision, ...) \
+	add_failure_until_args(cta, revision, __VA_ARGS__, 0, 0, 0, 0)
+
+#define add_failure_until_args(cta, revision, code, arg0, arg1, arg2, ...) \
+	do { \
+		if (DI_FAILURE_ENABLED(code)) \
+			emit_failure_until(cta, revision, code, arg0, arg1, arg2); \
+	} while (0)
+
 static bool
 parse_video_block(struct di_edid_cta *cta, struct di_cta_video_block *video,
 		  const uint8_t *data, size_t size)
 {
 	size_t i;
 	uint8_t raw;
-	struct di_cta_svd svd, *svd_ptr;
+	struct di_cta_svd svd;
 
 	if (size == 0)
-		add_failure(cta, "Video Data Block: Empty Data Block");
+		add_failure(cta, DI_FAILURE_CTA_VIDEO_EMPTY);
+
+	/* Each SVD takes one byte, so the block size bounds the SVD count.
+	 * The SVDs are not stored when only validating the block. */
+	if (cta->arena) {
+		video->svds = _di_arena_alloc(cta->arena, size * sizeof(*video->svds));
+		video->svd_ptrs = _di_arena_alloc(cta->arena,
+						  (size + 1) * sizeof(*video->svd_ptrs));
+		if (!video->svds || !video->svd_ptrs)
+			return false;
+	}
 
 	for (i = 0; i < size; i++) {
 		raw = data[i];
 
 		if (raw == 0 || raw == 128 || raw >= 254) {
 			/* Reserved */
-			add_failure_until(cta, 3,
-					  "Video Data Block: Unknown VIC %" PRIu8 ".",
+			add_failure_until(cta, 3, DI_FAILURE_CTA_VIDEO_UNKNOWN_VIC,
 					  raw);
 			continue;
+		} else if (!video->svds) {
+			continue;
 		} else if (raw <= 127 || raw >= 193) {
 			svd = (struct di_cta_svd) {
 				.vic = raw,
@@ -74,12 +104,10 @@ parse_video_block(struct di_edid_cta *cta, struct di_cta_video_block *video,
 			};
 		}
 
-		svd_ptr = calloc(1, sizeof(*svd_ptr));
-		if (!svd_ptr)
-			return false;
-		*svd_ptr = svd;
 		assert(video->svds_len < EDID_CTA_MAX_VIDEO_BLOCK_ENTRIES);
-		video->svds[video->svds_len++] = svd_ptr;
+		video->svds[video->svds_len] = svd;
+		video->svd_ptrs[video->svds_len] = &video->svds[video->svds_len];
+		video->svds_len++;
 	}
 
 	return true;
@@ -91,9 +119,7 @@ parse_video_cap_block(struct di_edid_cta *cta,
 		      const uint8_t *data, size_t size)
 {
 	if (size < 1) {
-		add_failure(cta,
-			    "Video Capability Data Block: Empty Data Block with length %u.",
-			    size);
+		add_failure(cta, DI_FAILURE_CTA_VIDEO_CAP_EMPTY, size);
 		return false;
 	}
 
@@ -104,19 +130,20 @@ parse_video_cap_block(struct di_edid_cta *cta,
 	video_cap->ce_over_underscan = get_bit_range(data[0], 1, 0);
 
 	if (!video_cap->selectable_rgb_quantization_range && cta->revision >= 3)
-		add_failure(cta,
-			    "Video Capability Data Block: Set Selectable RGB Quantization to avoid interop issues.");
+		add_failure(cta, DI_FAILURE_CTA_VIDEO_CAP_NO_SELECTABLE_RGB_QUANT);
 	/* TODO: add failure if selectable_ycc_quantization_range is unset,
 	 * the sink supports YCbCr formats and the revision is 3+ */
 
 	switch (video_cap->it_over_underscan) {
 	case DI_CTA_VIDEO_CAP_ALWAYS_OVERSCAN:
 		if (cta->flags.it_underscan)
-			add_failure(cta, "Video Capability Data Block: IT video formats are always overscanned, but bit 7 of Byte 3 of the CTA-861 Extension header is set to underscanned.");
+			add_failure(cta, DI_FAILURE_CTA_VIDEO_CAP_IT_SCAN_MISMATCH,
+				    cta->flags.it_underscan);
 		break;
 	case DI_CTA_VIDEO_CAP_ALWAYS_UNDERSCAN:
 		if (!cta->flags.it_underscan)
-			add_failure(cta, "Video Capability Data Block: IT video formats are always underscanned, but bit 7 of Byte 3 of the CTA-861 Extension header is set to overscanned.");
+			add_failure(cta, DI_FAILURE_CTA_VIDEO_CAP_IT_SCAN_MISMATCH,
+				    cta->flags.it_underscan);
 	default:
 		break;
 	}
@@ -130,8 +157,7 @@ parse_colorimetry_block(struct di_edid_cta *cta,
 			const uint8_t *data, size_t size)
 {
 	if (size < 2) {
-		add_failure(cta, "Colorimetry Data Block: Empty Data Block with length %u.",
-			    size);
+		add_failure(cta, DI_FAILURE_CTA_COLORIMETRY_EMPTY, size);
 		return false;
 	}
 
@@ -148,8 +174,7 @@ parse_colorimetry_block(struct di_edid_cta *cta,
 	colorimetry->ictcp = has_bit(data[1], 6);
 
 	if (get_bit_range(data[1], 5, 0) != 0)
-		add_failure_until(cta, 3,
-				  "Colorimetry Data Block: Reserved bits MD0-MD3 must be 0.");
+		add_failure_until(cta, 3, DI_FAILURE_CTA_COLORIMETRY_RESERVED_BITS);
 
 	return true;
 }
@@ -178,7 +203,7 @@ parse_hdr_static_metadata_block(struct di_edid_cta *cta,
 	uint8_t eotfs, descriptors;
 
 	if (size < 2) {
-		add_failure(cta, "HDR Static Metadata Data Block: Empty Data Block with length %u.",
+		add_failure(cta, DI_FAILURE_CTA_HDR_STATIC_METADATA_EMPTY,
 			    size);
 		return false;
 	}
@@ -192,12 +217,12 @@ parse_hdr_static_metadata_block(struct di_edid_cta *cta,
 	metadata->eotfs.pq = has_bit(eotfs, 2);
 	metadata->eotfs.hlg = has_bit(eotfs, 3);
 	if (get_bit_range(eotfs, 7, 4))
-		add_failure_until(cta, 3, "HDR Static Metadata Data Block: Unknown EOTF.");
+		add_failure_until(cta, 3, DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_EOTF);
 
 	descriptors = data[1];
 	metadata->descriptors.type1 = has_bit(descriptors, 0);
 	if (get_bit_range(descriptors, 7, 1))
-		add_failure_until(cta, 3, "HDR Static Metadata Data Block: Unknown descriptor type.");
+		add_failure_until(cta, 3, DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_DESCRIPTOR);
 
 	if (size > 2)
 		metadata->base.desired_content_max_luminance = parse_max_luminance(data[2]);
@@ -205,7 +230,7 @@ parse_hdr_static_metadata_block(struct di_edid_cta *cta,
 		metadata->base.desired_content_max_frame_avg_luminance = parse_max_luminance(data[3]);
 	if (size > 4) {
 		if (metadata->base.desired_content_max_luminance == 0)
-			add_failure(cta, "HDR Static Metadata Data Block: Desired content min luminance is set, but max luminance is unset.");
+			add_failure(cta, DI_FAILURE_CTA_HDR_STATIC_METADATA_MIN_WITHOUT_MAX);
 		else
 			metadata->base.desired_content_min_luminance =
 				parse_min_luminance(data[4], metadata->base.desired_content_max_luminance);
@@ -222,7 +247,7 @@ parse_vesa_transfer_characteristics_block(struct di_edid_cta *cta,
 	size_t i;
 
 	if (size != 7 && size != 15 && size != 31) {
-		add_failure(cta, "Invalid length %u.", size);
+		add_failure(cta, DI_FAILURE_CTA_INVALID_DATA_BLOCK_LENGTH, size);
 		return false;
 	}
 
@@ -237,168 +262,272 @@ parse_vesa_transfer_characteristics_block(struct di_edid_cta *cta,
 	return true;
 }
 
-static void
-destroy_data_block(struct di_cta_data_block *data_block)
-{
-	size_t i;
-	struct di_cta_video_block *video;
-
-	switch (data_block->tag) {
-	case DI_CTA_DATA_BLOCK_VIDEO:
-		video = &data_block->video;
-		for (i = 0; i < video->svds_len; i++)
-			free(video->svds[i]);
-		break;
-	default:
-		break; /* Nothing to do */
-	}
-
-	free(data_block);
-}
-
+/**
+ * Get the tag of a data block. For extended tags, the payload starts with the
+ * extended tag. Returns false if the data block is not decoded: it is
+ * vendor-specific, reserved or empty.
+ */
 static bool
-parse_data_block(struct di_edid_cta *cta, uint8_t raw_tag, const uint8_t *data, size_t size)
+get_data_block_tag(uint8_t raw_tag, const uint8_t *data, size_t size,
+		   enum di_cta_data_block_tag *tag)
 {
-	enum di_cta_data_block_tag tag;
-	uint8_t extended_tag;
-	struct di_cta_data_block *data_block;
-
-	data_block = calloc(1, sizeof(*data_block));
-	if (!data_block) {
-		return false;
-	}
-
 	switch (raw_tag) {
 	case 1:
-		tag = DI_CTA_DATA_BLOCK_AUDIO;
-		break;
+		*tag = DI_CTA_DATA_BLOCK_AUDIO;
+		return true;
 	case 2:
-		tag = DI_CTA_DATA_BLOCK_VIDEO;
-		if (!parse_video_block(cta, &data_block->video, data, size))
-			goto error;
-		break;
-	case 3:
-		/* Vendor-Specific Data Block */
-		goto skip;
+		*tag = DI_CTA_DATA_BLOCK_VIDEO;
+		return true;
 	case 4:
-		tag = DI_CTA_DATA_BLOCK_SPEAKER_ALLOC;
-		break;
+		*tag = DI_CTA_DATA_BLOCK_SPEAKER_ALLOC;
+		return true;
 	case 5:
-		tag = DI_CTA_DATA_BLOCK_VESA_DISPLAY_TRANSFER_CHARACTERISTIC;
-		if (!parse_vesa_transfer_characteristics_block(cta,
-							       &data_block->vesa_transfer_characteristics,
-							       data, size))
-			goto error;
-		break;
+		*tag = DI_CTA_DATA_BLOCK_VESA_DISPLAY_TRANSFER_CHARACTERISTIC;
+		return true;
 	case 7:
 		/* Use Extended Tag */
-		if (size < 1) {
-			add_failure(cta, "Empty block with extended tag.");
-			goto skip;
-		}
-
-		extended_tag = data[0];
-		data = &data[1];
-		size--;
+		if (size < 1)
+			return false;
 
-		switch (extended_tag) {
+		switch (data[0]) {
 		case 0:
-			tag = DI_CTA_DATA_BLOCK_VIDEO_CAP;
-			if (!parse_video_cap_block(cta, &data_block->video_cap,
-						   data, size))
-				goto skip;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_VIDEO_CAP;
+			return true;
 		case 2:
-			tag = DI_CTA_DATA_BLOCK_VESA_DISPLAY_DEVICE;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_VESA_DISPLAY_DEVICE;
+			return true;
 		case 5:
-			tag = DI_CTA_DATA_BLOCK_COLORIMETRY;
-			if (!parse_colorimetry_block(cta,
-						     &data_block->colorimetry,
-						     data, size))
-				goto skip;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_COLORIMETRY;
+			return true;
 		case 6:
-			tag = DI_CTA_DATA_BLOCK_HDR_STATIC_METADATA;
-			if (!parse_hdr_static_metadata_block(cta,
-							     &data_block->hdr_static_metadata,
-							     data, size))
-				goto skip;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_HDR_STATIC_METADATA;
+			return true;
 		case 7:
-			tag = DI_CTA_DATA_BLOCK_HDR_DYNAMIC_METADATA;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_HDR_DYNAMIC_METADATA;
+			return true;
 		case 13:
-			tag = DI_CTA_DATA_BLOCK_VIDEO_FORMAT_PREF;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_VIDEO_FORMAT_PREF;
+			return true;
 		case 14:
-			tag = DI_CTA_DATA_BLOCK_YCBCR420;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_YCBCR420;
+			return true;
 		case 15:
-			tag = DI_CTA_DATA_BLOCK_YCBCR420_CAP_MAP;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_YCBCR420_CAP_MAP;
+			return true;
 		case 18:
-			tag = DI_CTA_DATA_BLOCK_HDMI_AUDIO;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_HDMI_AUDIO;
+			return true;
 		case 19:
-			tag = DI_CTA_DATA_BLOCK_ROOM_CONFIG;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_ROOM_CONFIG;
+			return true;
 		case 20:
-			tag = DI_CTA_DATA_BLOCK_SPEAKER_LOCATION;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_SPEAKER_LOCATION;
+			return true;
 		case 32:
-			tag = DI_CTA_DATA_BLOCK_INFOFRAME;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_INFOFRAME;
+			return true;
 		case 34:
-			tag = DI_CTA_DATA_BLOCK_DISPLAYID_VIDEO_TIMING_VII;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_DISPLAYID_VIDEO_TIMING_VII;
+			return true;
 		case 35:
-			tag = DI_CTA_DATA_BLOCK_DISPLAYID_VIDEO_TIMING_VIII;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_DISPLAYID_VIDEO_TIMING_VIII;
+			return true;
 		case 42:
-			tag = DI_CTA_DATA_BLOCK_DISPLAYID_VIDEO_TIMING_X;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_DISPLAYID_VIDEO_TIMING_X;
+			return true;
 		case 120:
-			tag = DI_CTA_DATA_BLOCK_HDMI_EDID_EXT_OVERRIDE;
-			break;
+			*tag = DI_CTA_DATA_BLOCK_HDMI_EDID_EXT_OVERRIDE;
+			return true;
 		case 121:
-			tag = DI_CTA_DATA_BLOCK_HDMI_SINK_CAP;
+			*tag = DI_CTA_DATA_BLOCK_HDMI_SINK_CAP;
+			return true;
+		default:
+			return false;
+		}
+	default:
+		return false;
+	}
+}
+
+/**
+ * Report a data block which is not decoded, unless it is vendor-specific.
+ */
+static void
+check_undecoded_data_block(struct di_edid_cta *cta, uint8_t raw_tag,
+			   const uint8_t *data, size_t size)
+{
+	uint8_t extended_tag;
+
+	switch (raw_tag) {
+	case 3:
+		/* Vendor-Specific Data Block */
+		break;
+	case 7:
+		if (size < 1) {
+			add_failure(cta, DI_FAILURE_CTA_EMPTY_EXTENDED_DATA_BLOCK);
 			break;
+		}
+
+		extended_tag = data[0];
+		switch (extended_tag) {
 		case 1: /* Vendor-Specific Video Data Block */
 		case 17: /* Vendor-Specific Audio Data Block */
-			goto skip;
+			break;
 		default:
 			/* Reserved */
-			add_failure_until(cta, 3,
-					  "Unknown CTA-861 Data Block (extended tag 0x"PRIx8", length %zu).",
-					  extended_tag, size);
-			goto skip;
+			add_failure_until(cta, 3, DI_FAILURE_CTA_UNKNOWN_EXTENDED_DATA_BLOCK,
+					  extended_tag, size - 1);
+			break;
 		}
 		break;
 	default:
 		/* Reserved */
-		add_failure_until(cta, 3, "Unknown CTA-861 Data Block (tag 0x"PRIx8", length %zu).",
+		add_failure_until(cta, 3, DI_FAILURE_CTA_UNKNOWN_DATA_BLOCK,
 				  raw_tag, size);
+		break;
+	}
+}
+
+static bool
+parse_data_block(struct di_edid_cta *cta, uint8_t raw_tag, const uint8_t *data, size_t size)
+{
+	enum di_cta_data_block_tag tag;
+	struct di_cta_data_block *data_block, scratch = {0};
+
+	if (!get_data_block_tag(raw_tag, data, size, &tag)) {
+		check_undecoded_data_block(cta, raw_tag, data, size);
+		return true;
+	}
+
+	if (raw_tag == 7) {
+		data = &data[1];
+		size--;
+	}
+
+	if (cta->skip_data_blocks & ((uint64_t) 1 << tag))
 		goto skip;
+
+	/* When only validating, the data block is decoded on the stack and
+	 * dropped */
+	if (cta->arena) {
+		data_block = _di_arena_alloc(cta->arena, sizeof(*data_block));
+		if (!data_block)
+			goto error;
+	} else {
+		data_block = &scratch;
+	}
+
+	switch (tag) {
+	case DI_CTA_DATA_BLOCK_VIDEO:
+		if (!parse_video_block(cta, &data_block->video, data, size))
+			goto error;
+		break;
+	case DI_CTA_DATA_BLOCK_VESA_DISPLAY_TRANSFER_CHARACTERISTIC:
+		if (!parse_vesa_transfer_characteristics_block(cta,
+							       &data_block->vesa_transfer_characteristics,
+							       data, size))
+			goto error;
+		break;
+	case DI_CTA_DATA_BLOCK_VIDEO_CAP:
+		if (!parse_video_cap_block(cta, &data_block->video_cap,
+					   data, size))
+			goto skip;
+		break;
+	case DI_CTA_DATA_BLOCK_COLORIMETRY:
+		if (!parse_colorimetry_block(cta, &data_block->colorimetry,
+					     data, size))
+			goto skip;
+		break;
+	case DI_CTA_DATA_BLOCK_HDR_STATIC_METADATA:
+		if (!parse_hdr_static_metadata_block(cta,
+						     &data_block->hdr_static_metadata,
+						     data, size))
+			goto skip;
+		break;
+	default:
+		break; /* No payload */
 	}
 
 	data_block->tag = tag;
-	assert(cta->data_blocks_len < EDID_CTA_MAX_DATA_BLOCKS);
-	cta->data_blocks[cta->data_blocks_len++] = data_block;
+	if (cta->data_blocks)
+		cta->data_blocks[cta->data_blocks_len++] = data_block;
 	return true;
 
 skip:
-	free(data_block);
 	return true;
 
 error:
-	destroy_data_block(data_block);
 	return false;
 }
 
+/**
+ * Count the data block headers before the detailed timing definitions. This is
+ * an upper bound for the number of data blocks stored by _di_edid_cta_parse().
+ */
+static size_t
+count_data_blocks(const uint8_t *data, uint8_t dtd_start)
+{
+	size_t i, n;
+
+	n = 0;
+	i = CTA_HEADER_SIZE;
+	while (i < dtd_start) {
+		n++;
+		i += 1 + get_bit_range(data[i], 4, 0);
+	}
+
+	return n;
+}
+
+size_t
+_di_edid_cta_get_parse_size(const uint8_t *data, size_t size)
+{
+	uint8_t dtd_start, data_block_tag, data_block_size;
+	enum di_cta_data_block_tag tag;
+	size_t parse_size, i;
+
+	assert(size == 128);
+
+	dtd_start = data[2];
+	if (dtd_start >= size)
+		return 0;
+
+	parse_size = _di_arena_get_alloc_size((count_data_blocks(data, dtd_start) + 1)
+					      * sizeof(struct di_cta_data_block *));
+	if (dtd_start < CTA_HEADER_SIZE)
+		return parse_size;
+
+	i = CTA_HEADER_SIZE;
+	while (i < dtd_start) {
+		data_block_tag = get_bit_range(data[i], 7, 5);
+		data_block_size = get_bit_range(data[i], 4, 0);
+		if (i + 1 + data_block_size > dtd_start)
+			break;
+
+		if (get_data_block_tag(data_block_tag, &data[i + 1],
+				       data_block_size, &tag))
+			parse_size += _di_arena_get_alloc_size(sizeof(struct di_cta_data_block));
+		if (data_block_tag == 2)
+			parse_size += _di_arena_get_alloc_size(data_block_size * sizeof(struct di_cta_svd))
+				      + _di_arena_get_alloc_size((data_block_size + 1u) * sizeof(struct di_cta_svd *));
+
+		i += 1 + data_block_size;
+	}
+
+	for (i = dtd_start; i + EDID_BYTE_DESCRIPTOR_SIZE <= CTA_DTD_END;
+	     i += EDID_BYTE_DESCRIPTOR_SIZE) {
+		if (data[i] == 0)
+			break;
+		parse_size += _di_arena_get_alloc_size(sizeof(struct di_edid_detailed_timing_def_priv));
+	}
+
+	return parse_size;
+}
+
 bool
 _di_edid_cta_parse(struct di_edid_cta *cta, const uint8_t *data, size_t size,
-		   struct di_logger *logger)
+		   struct di_arena *arena, struct di_logger *logger,
+		   uint64_t skip_data_blocks)
 {
 	uint8_t flags, dtd_start;
 	uint8_t data_block_header, data_block_tag, data_block_size;
@@ -409,6 +538,8 @@ _di_edid_cta_parse(struct di_edid_cta *cta, const uint8_t *data, size_t size,
 	assert(data[0] == 0x02);
 
 	cta->logger = logger;
+	cta->arena = arena;
+	cta->skip_data_blocks = skip_data_blocks;
 
 	cta->revision = data[1];
 	dtd_start = data[2];
@@ -422,16 +553,24 @@ _di_edid_cta_parse(struct di_edid_cta *cta, const uint8_t *data, size_t size,
 		cta->flags.native_dtds = get_bit_range(flags, 3, 0);
 	} else if (flags != 0) {
 		/* Reserved */
-		add_failure(cta, "Non-zero byte 3.");
+		add_failure(cta, DI_FAILURE_CTA_NON_ZERO_BYTE_3);
 	}
 
-	if (dtd_start == 0) {
-		return true;
-	} else if (dtd_start < CTA_HEADER_SIZE || dtd_start >= size) {
+	if (dtd_start != 0 && (dtd_start < CTA_HEADER_SIZE || dtd_start >= size)) {
 		errno = EINVAL;
 		return false;
 	}
 
+	if (arena) {
+		cta->data_blocks = _di_arena_alloc(arena, (count_data_blocks(data, dtd_start) + 1)
+							  * sizeof(*cta->data_blocks));
+		if (!cta->data_blocks)
+			return false;
+	}
+
+	if (dtd_start == 0)
+		return true;
+
 	i = CTA_HEADER_SIZE;
 	while (i < dtd_start) {
 		data_block_header = data[i];
@@ -439,14 +578,12 @@ _di_edid_cta_parse(struct di_edid_cta *cta, const uint8_t *data, size_t size,
 		data_block_size = get_bit_range(data_block_header, 4, 0);
 
 		if (i + 1 + data_block_size > dtd_start) {
-			_di_edid_cta_finish(cta);
 			errno = EINVAL;
 			return false;
 		}
 
 		if (!parse_data_block(cta, data_block_tag,
 				      &data[i + 1], data_block_size)) {
-			_di_edid_cta_finish(cta);
 			return false;
 		}
 
@@ -454,17 +591,18 @@ _di_edid_cta_parse(struct di_edid_cta *cta, const uint8_t *data, size_t size,
 	}
 
 	if (i != dtd_start)
-		add_failure(cta, "Offset is %"PRIu8", but should be %zu.",
+		add_failure(cta, DI_FAILURE_CTA_INVALID_DTD_OFFSET,
 			    dtd_start, i);
 
 	for (i = dtd_start; i + EDID_BYTE_DESCRIPTOR_SIZE <= CTA_DTD_END;
 	     i += EDID_BYTE_DESCRIPTOR_SIZE) {
 		if (data[i] == 0)
 			break;
+		if (!arena)
+			continue; /* Nothing to validate */
 
-		detailed_timing_def = _di_edid_parse_detailed_timing_def(&data[i]);
+		detailed_timing_def = _di_edid_parse_detailed_timing_def(arena, &data[i]);
 		if (!detailed_timing_def) {
-			_di_edid_cta_finish(cta);
 			return false;
 		}
 		assert(cta->detailed_timing_defs_len < EDID_CTA_MAX_DETAILED_TIMING_DEFS);
@@ -474,28 +612,23 @@ _di_edid_cta_parse(struct di_edid_cta *cta, const uint8_t *data, size_t size,
 	/* All padding bytes after the last DTD must be zero */
 	while (i < CTA_DTD_END) {
 		if (data[i] != 0) {
-			add_failure(cta, "Padding: Contains non-zero bytes.");
+			add_failure(cta, DI_FAILURE_CTA_NON_ZERO_PADDING);
 			break;
 		}
 		i++;
 	}
 
 	cta->logger = NULL;
+	cta->arena = NULL;
 	return true;
 }
 
-void
-_di_edid_cta_finish(struct di_edid_cta *cta)
+bool
+_di_edid_cta_check(const uint8_t *data, size_t size, struct di_logger *logger)
 {
-	size_t i;
+	struct di_edid_cta cta = {0};
 
-	for (i = 0; i < cta->data_blocks_len; i++) {
-		destroy_data_block(cta->data_blocks[i]);
-	}
-
-	for (i = 0; i < cta->detailed_timing_defs_len; i++) {
-		free(cta->detailed_timing_defs[i]);
-	}
+	return _di_edid_cta_parse(&cta, data, size, NULL, logger, 0);
 }
 
 int
@@ -516,6 +649,13 @@ di_edid_cta_get_data_blocks(const struct di_edid_cta *cta)
 	return (const struct di_cta_data_block *const *) cta->data_blocks;
 }
 
+const struct di_cta_data_block *const *
+di_edid_cta_get_data_blocks_span(const struct di_edid_cta *cta, size_t *len)
+{
+	*len = cta->data_blocks_len;
+	return di_edid_cta_get_data_blocks(cta);
+}
+
 enum di_cta_data_block_tag
 di_cta_data_block_get_tag(const struct di_cta_data_block *block)
 {
@@ -528,7 +668,19 @@ di_cta_data_block_get_svds(const struct di_cta_data_block *block)
 	if (block->tag != DI_CTA_DATA_BLOCK_VIDEO) {
 		return NULL;
 	}
-	return (const struct di_cta_svd *const *) block->video.svds;
+	return (const struct di_cta_svd *const *) block->video.svd_ptrs;
+}
+
+const struct di_cta_svd *
+di_cta_data_block_get_svds_span(const struct di_cta_data_block *block,
+				size_t *len)
+{
+	if (block->tag != DI_CTA_DATA_BLOCK_VIDEO) {
+		*len = 0;
+		return NULL;
+	}
+	*len = block->video.svds_len;
+	return block->video.svds;
 }
 
 const struct di_cta_colorimetry_block *
@@ -564,6 +716,14 @@ di_edid_cta_get_detailed_timing_defs(const struct di_edid_cta *cta)
 	return (const struct di_edid_detailed_timing_def *const *) cta->detailed_timing_defs;
 }
 
+const struct di_edid_detailed_timing_def *const *
+di_edid_cta_get_detailed_timing_defs_span(const struct di_edid_cta *cta,
+					  size_t *len)
+{
+	*len = cta->detailed_timing_defs_len;
+	return di_edid_cta_get_detailed_timing_defs(cta);
+}
+
 const struct di_cta_vesa_transfer_characteristics *
 di_cta_data_block_get_vesa_transfer_characteristics(const struct di_cta_data_block *block)
 {
@@ -572,3 +732,58 @@ di_cta_data_block_get_vesa_transfer_characteristics(const struct di_cta_data_blo
 	}
 	return &block->vesa_transfer_characteristics;
 }
+
+bool
+di_edid_view_next_cta_data_block(const struct di_edid_view *view, size_t index,
+				 size_t *offset,
+				 struct di_edid_view_cta_data_block *data_block)
+{
+	const uint8_t *data;
+	uint8_t dtd_start, data_block_header, data_block_size;
+	size_t i;
+
+	if (index >= di_edid_view_get_extension_count(view))
+		return false;
+
+	data = &view->data[(index + 1) * EDID_BLOCK_SIZE];
+	if (data[0] != DI_EDID_EXT_CEA)
+		return false;
+
+	dtd_start = data[2];
+	if (dtd_start < CTA_HEADER_SIZE || dtd_start >= EDID_BLOCK_SIZE)
+		return false;
+
+	if (*offset == 0) {
+		if (!_di_edid_validate_block_checksum(data))
+			return false;
+		*offset = CTA_HEADER_SIZE;
+	}
+
+	for (i = *offset; i < dtd_start; i += 1 + data_block_size) {
+		data_block_header = data[i];
+		data_block_size = get_bit_range(data_block_header, 4, 0);
+		if (i + 1 + data_block_size > dtd_start)
+			return false;
+
+		*data_block = (struct di_edid_view_cta_data_block) {
+			.tag_code = get_bit_range(data_block_header, 7, 5),
+			.data = &data[i + 1],
+			.size = data_block_size,
+		};
+
+		if (data_block->tag_code == 7) {
+			/* Use Extended Tag */
+			if (data_block_size < 1)
+				continue;
+			data_block->extended_tag_code = data[i + 1];
+			data_block->data++;
+			data_block->size--;
+		}
+
+		*offset = i + 1 + data_block_size;
+		return true;
+	}
+
+	*offset = i;
+	return false;
+}
@@ -24,21 +24,33 @@
 #define DISPLAYID_TYPE_I_TIMING_SIZE 20
 
 static void
-add_failure(struct di_displayid *displayid, const char fmt[], ...)
+emit_failure(struct di_displayid *displayid, enum di_failure_code code,
+	     uintmax_t arg0, uintmax_t arg1, uintmax_t arg2)
 {
-	va_list args;
+	const uintmax_t args[DI_LOG_MAX_ARGS] = { arg0, arg1, arg2 };
 
-	va_start(args, fmt);
-	_di_logger_va_add_failure(displayid->logger, fmt, args);
-	va_end(args);
+	if (!displayid->logger) {
+		return;
+	}
+
+	_di_logger_add_failure(displayid->logger, code, args);
 }
 
+#define add_failure(displayid, ...) \
+	add_failure_args(displayid, __VA_ARGS__, 0, 0, 0, 0)
+
+#define add_failure_args(displayid, code, arg0, arg1, arg2, ...) \
+	do { \
+		if (DI_FAILURE_ENABLED(code)) \
+			emit_failure(displayid, code, arg0, arg1, arg2); \
+	} while (0)
+
 typedef intptr_t ssize_t;
 
 static void
 check_data_block_revision(struct di_displayid *displayid,
 			  const uint8_t data[static_array DISPLAYID_DATA_BLOCK_HEADER_SIZE],
-			  const char *block_name, uint8_t max_revision)
+			  uint8_t max_revision)
 {
 	uint8_t revision, flags;
 
@@ -46,12 +58,12 @@ check_data_block_revision(struct di_displayid *displayid,
 	revision = get_bit_range(data[0x01], 2, 0);
 
 	if (revision > max_revision) {
-		add_failure(displayid, "%s: Unexpected revision (%u != %u).",
-			    block_name, revision, max_revision);
+		add_failure(displayid, DI_FAILURE_DISPLAYID_UNEXPECTED_REVISION,
+			    data[0x00], revision, max_revision);
 	}
 	if (flags != 0) {
-		add_failure(displayid, "%s: Unexpected flags (0x%02x).",
-			    block_name, flags);
+		add_failure(displayid, DI_FAILURE_DISPLAYID_UNEXPECTED_FLAGS,
+			    data[0x00], flags);
 	}
 }
 
@@ -63,12 +75,11 @@ parse_display_params_block(struct di_displayid *displayid,
 	struct di_displayid_display_params *params = &priv->base;
 	uint8_t raw_features;
 
-	check_data_block_revision(displayid, data,
-				  "Display Parameters Data Block",
-				  0);
+	check_data_block_revision(displayid, data, 0);
 
 	if (size != 0x0F) {
-		add_failure(displayid, "Display Parameters Data Block: DisplayID payload length is different than expected (%zu != %zu)", size, 0x0F);
+		add_failure(displayid, DI_FAILURE_DISPLAYID_DISPLAY_PARAMS_INVALID_LENGTH,
+			    size);
 		return false;
 	}
 
@@ -98,7 +109,7 @@ parse_display_params_block(struct di_displayid *displayid,
 	return true;
 }
 
-static bool
+static void
 parse_type_i_timing(struct di_displayid *displayid,
 		    struct di_displayid_data_block *data_block,
 		    const uint8_t data[static_array DISPLAYID_TYPE_I_TIMING_SIZE])
@@ -106,9 +117,15 @@ parse_type_i_timing(struct di_displayid *displayid,
 	int raw_pixel_clock;
 	uint8_t stereo_3d, aspect_ratio;
 
-	struct di_displayid_type_i_timing *t = calloc(1, sizeof(*t));
-	if (t == NULL) {
-		return false;
+	struct di_displayid_type_i_timing *t, scratch;
+
+	/* When only validating, the timing is decoded on the stack and
+	 * dropped */
+	if (data_block->type_i_timings) {
+		assert(data_block->type_i_timings_len < DISPLAYID_MAX_TYPE_I_TIMINGS);
+		t = &data_block->type_i_timings[data_block->type_i_timings_len];
+	} else {
+		t = &scratch;
 	}
 
 	raw_pixel_clock = data[0] | (data[1] << 8) | (data[2] << 16);
@@ -125,8 +142,7 @@ parse_type_i_timing(struct di_displayid *displayid,
 		t->stereo_3d = stereo_3d;
 		break;
 	default:
-		add_failure(displayid,
-			    "Video Timing Modes Type 1 - Detailed Timings Data Block: Reserved stereo 0x%02x.",
+		add_failure(displayid, DI_FAILURE_DISPLAYID_TYPE_I_TIMING_RESERVED_STEREO,
 			    stereo_3d);
 		break;
 	}
@@ -146,8 +162,7 @@ parse_type_i_timing(struct di_displayid *displayid,
 		break;
 	default:
 		t->aspect_ratio = DI_DISPLAYID_TYPE_I_TIMING_ASPECT_RATIO_UNDEFINED;
-		add_failure(displayid,
-			    "Video Timing Modes Type 1 - Detailed Timings Data Block: Unknown aspect 0x%02x.",
+		add_failure(displayid, DI_FAILURE_DISPLAYID_TYPE_I_TIMING_UNKNOWN_ASPECT,
 			    aspect_ratio);
 		break;
 	}
@@ -163,9 +178,8 @@ parse_type_i_timing(struct di_displayid *displayid,
 	t->vert_sync_polarity = has_bit(data[17], 7);
 	t->vert_sync_width = 1 + (data[18] | (data[19] << 8));
 
-	assert(data_block->type_i_timings_len < DISPLAYID_MAX_TYPE_I_TIMINGS);
-	data_block->type_i_timings[data_block->type_i_timings_len++] = t;
-	return true;
+	if (data_block->type_i_timing_ptrs)
+		data_block->type_i_timing_ptrs[data_block->type_i_timings_len++] = t;
 }
 
 static bool
@@ -173,25 +187,29 @@ parse_type_i_timing_block(struct di_displayid *displayid,
 			  struct di_displayid_data_block *data_block,
 			  const uint8_t *data, size_t size)
 {
-	size_t i;
+	size_t i, count;
 
-	check_data_block_revision(displayid, data,
-				  "Video Timing Modes Type 1 - Detailed Timings Data Block",
-				  1);
+	check_data_block_revision(displayid, data, 1);
 
 	if ((size - DISPLAYID_DATA_BLOCK_HEADER_SIZE) % DISPLAYID_TYPE_I_TIMING_SIZE != 0) {
-		add_failure(displayid,
-			    "Video Timing Modes Type 1 - Detailed Timings Data Block: payload size not divisible by element size.");
+		add_failure(displayid, DI_FAILURE_DISPLAYID_TYPE_I_TIMING_INVALID_SIZE);
 	}
 
-	for (i = DISPLAYID_DATA_BLOCK_HEADER_SIZE;
-	     i + DISPLAYID_TYPE_I_TIMING_SIZE <= size;
-	     i += DISPLAYID_TYPE_I_TIMING_SIZE) {
-		if (!parse_type_i_timing(displayid, data_block, &data[i])) {
+	count = (size - DISPLAYID_DATA_BLOCK_HEADER_SIZE) / DISPLAYID_TYPE_I_TIMING_SIZE;
+	if (displayid->arena) {
+		data_block->type_i_timings = _di_arena_alloc(displayid->arena,
+							     count * sizeof(*data_block->type_i_timings));
+		data_block->type_i_timing_ptrs = _di_arena_alloc(displayid->arena,
+								 (count + 1) * sizeof(*data_block->type_i_timing_ptrs));
+		if (!data_block->type_i_timings || !data_block->type_i_timing_ptrs)
 			return false;
-		}
 	}
 
+	for (i = DISPLAYID_DATA_BLOCK_HEADER_SIZE;
+	     i + DISPLAYID_TYPE_I_TIMING_SIZE <= size;
+	     i += DISPLAYID_TYPE_I_TIMING_SIZE)
+		parse_type_i_timing(displayid, data_block, &data[i]);
+
 	return true;
 }
 
@@ -201,22 +219,30 @@ parse_data_block(struct di_displayid *displayid, const uint8_t *data,
 {
 	uint8_t tag;
 	size_t data_block_size;
-	struct di_displayid_data_block *data_block = NULL;
+	struct di_displayid_data_block *data_block = NULL, scratch = {0};
 
 	assert(size >= DISPLAYID_DATA_BLOCK_HEADER_SIZE);
 
 	tag = data[0x00];
 	data_block_size = (size_t) data[0x02] + DISPLAYID_DATA_BLOCK_HEADER_SIZE;
 	if (data_block_size > size) {
-		add_failure(displayid,
-			    "The length of this DisplayID data block (%d) exceeds the number of bytes remaining (%zu)",
+		add_failure(displayid, DI_FAILURE_DISPLAYID_DATA_BLOCK_OVERFLOW,
 			    data_block_size, size);
 		goto skip;
 	}
 
-	data_block = calloc(1, sizeof(*data_block));
-	if (!data_block)
-		goto error;
+	if (tag < 64 && (displayid->skip_data_blocks & ((uint64_t) 1 << tag)))
+		goto skip;
+
+	/* When only validating, the data block is decoded on the stack and
+	 * dropped */
+	if (displayid->arena) {
+		data_block = _di_arena_alloc(displayid->arena, sizeof(*data_block));
+		if (!data_block)
+			goto error;
+	} else {
+		data_block = &scratch;
+	}
 
 	switch (tag) {
 	case DI_DISPLAYID_DATA_BLOCK_DISPLAY_PARAMS:
@@ -251,24 +277,21 @@ parse_data_block(struct di_displayid *displayid, const uint8_t *data,
 	case 0x7F:
 		goto skip; /* Vendor-specific */
 	default:
-		add_failure(displayid,
-			    "Unknown DisplayID Data Block (0x%" PRIx8 ", length %" PRIu8 ")",
+		add_failure(displayid, DI_FAILURE_DISPLAYID_UNKNOWN_DATA_BLOCK,
 			    tag, data_block_size - DISPLAYID_DATA_BLOCK_HEADER_SIZE);
 		goto skip;
 	}
 
 	data_block->tag = tag;
 
-	assert(displayid->data_blocks_len < DISPLAYID_MAX_DATA_BLOCKS);
-	displayid->data_blocks[displayid->data_blocks_len++] = data_block;
+	if (displayid->data_blocks)
+		displayid->data_blocks[displayid->data_blocks_len++] = data_block;
 	return (ssize_t) data_block_size;
 
 skip:
-	free(data_block);
 	return (ssize_t) data_block_size;
 
 error:
-	free(data_block);
 	return -1;
 }
 
@@ -306,9 +329,68 @@ validate_checksum(const uint8_t *data, size_t size)
 	return sum == 0;
 }
 
+/**
+ * Count the data block headers in a section. This is an upper bound for the
+ * number of data blocks stored by _di_displayid_parse().
+ */
+static size_t
+count_data_blocks(const uint8_t *data, size_t section_size)
+{
+	size_t i, n;
+
+	n = 0;
+	i = DISPLAYID_MIN_SIZE - 1;
+	while (i < section_size - 1) {
+		if (is_data_block_end(&data[i], section_size - 1 - i))
+			break;
+		n++;
+		i += (size_t) data[i + 0x02] + DISPLAYID_DATA_BLOCK_HEADER_SIZE;
+	}
+
+	return n;
+}
+
+size_t
+_di_displayid_get_parse_size(const uint8_t *data, size_t size)
+{
+	size_t section_size, data_block_size, parse_size, count, i;
+
+	if (size < DISPLAYID_MIN_SIZE)
+		return 0;
+
+	section_size = (size_t) data[0x01] + DISPLAYID_MIN_SIZE;
+	if (section_size > DISPLAYID_MAX_SIZE || section_size > size)
+		return 0;
+
+	parse_size = _di_arena_get_alloc_size((count_data_blocks(data, section_size) + 1)
+					      * sizeof(struct di_displayid_data_block *));
+	i = DISPLAYID_MIN_SIZE - 1;
+	while (i < section_size - 1) {
+		if (is_data_block_end(&data[i], section_size - 1 - i))
+			break;
+
+		data_block_size = (size_t) data[i + 0x02] + DISPLAYID_DATA_BLOCK_HEADER_SIZE;
+		if (data_block_size > section_size - 1 - i)
+			break;
+
+		parse_size += _di_arena_get_alloc_size(sizeof(struct di_displayid_data_block));
+		if (data[i] == DI_DISPLAYID_DATA_BLOCK_TYPE_I_TIMING) {
+			count = (data_block_size - DISPLAYID_DATA_BLOCK_HEADER_SIZE)
+				/ DISPLAYID_TYPE_I_TIMING_SIZE;
+			parse_size += _di_arena_get_alloc_size(count * sizeof(struct di_displayid_type_i_timing))
+				      + _di_arena_get_alloc_size((count + 1) * sizeof(struct di_displayid_type_i_timing *));
+		}
+
+		i += data_block_size;
+	}
+
+	return parse_size;
+}
+
 bool
 _di_displayid_parse(struct di_displayid *displayid, const uint8_t *data,
-		    size_t size, struct di_logger *logger)
+		    size_t size, struct di_arena *arena,
+		    struct di_logger *logger, uint64_t skip_data_blocks)
 {
 	size_t section_size, i, max_data_block_size;
 	ssize_t data_block_size;
@@ -320,6 +402,8 @@ _di_displayid_parse(struct di_displayid *displayid, const uint8_t *data,
 	}
 
 	displayid->logger = logger;
+	displayid->arena = arena;
+	displayid->skip_data_blocks = skip_data_blocks;
 
 	displayid->version = get_bit_range(data[0x00], 7, 4);
 	displayid->revision = get_bit_range(data[0x00], 3, 0);
@@ -355,6 +439,13 @@ _di_displayid_parse(struct di_displayid *displayid, const uint8_t *data,
 		return false;
 	}
 
+	if (arena) {
+		displayid->data_blocks = _di_arena_alloc(arena, (count_data_blocks(data, section_size) + 1)
+							       * sizeof(*displayid->data_blocks));
+		if (!displayid->data_blocks)
+			return false;
+	}
+
 	i = DISPLAYID_MIN_SIZE - 1;
 	max_data_block_size = 0;
 	while (i < section_size - 1) {
@@ -370,41 +461,23 @@ _di_displayid_parse(struct di_displayid *displayid, const uint8_t *data,
 	}
 	if (!is_all_zeroes(&data[i], max_data_block_size)) {
 		if (max_data_block_size < DISPLAYID_DATA_BLOCK_HEADER_SIZE)
-			add_failure(displayid,
-				    "Not enough bytes remain (%zu) for a DisplayID data block and the DisplayID filler is non-0.",
+			add_failure(displayid, DI_FAILURE_DISPLAYID_NON_ZERO_FILLER,
 				    max_data_block_size);
 		else
-			add_failure(displayid, "Padding: Contains non-zero bytes.");
+			add_failure(displayid, DI_FAILURE_DISPLAYID_NON_ZERO_PADDING);
 	}
 
 	displayid->logger = NULL;
+	displayid->arena = NULL;
 	return true;
 }
 
-static void
-destroy_data_block(struct di_displayid_data_block *data_block)
-{
-	size_t i;
-
-	switch (data_block->tag) {
-	case DI_DISPLAYID_DATA_BLOCK_TYPE_I_TIMING:
-		for (i = 0; i < data_block->type_i_timings_len; i++)
-			free(data_block->type_i_timings[i]);
-		break;
-	default:
-		break; /* Nothing to do */
-	}
-
-	free(data_block);
-}
-
-void
-_di_displayid_finish(struct di_displayid *displayid)
+bool
+_di_displayid_check(const uint8_t *data, size_t size, struct di_logger *logger)
 {
-	size_t i;
+	struct di_displayid displayid = {0};
 
-	for (i = 0; i < displayid->data_blocks_len; i++)
-		destroy_data_block(displayid->data_blocks[i]);
+	return _di_displayid_parse(&displayid, data, size, NULL, logger, 0);
 }
 
 int
@@ -446,7 +519,19 @@ di_displayid_data_block_get_type_i_timings(const struct di_displayid_data_block
 	if (data_block->tag != DI_DISPLAYID_DATA_BLOCK_TYPE_I_TIMING) {
 		return NULL;
 	}
-	return (const struct di_displayid_type_i_timing *const *) data_block->type_i_timings;
+	return (const struct di_displayid_type_i_timing *const *) data_block->type_i_timing_ptrs;
+}
+
+const struct di_displayid_type_i_timing *
+di_displayid_data_block_get_type_i_timings_span(const struct di_displayid_data_block *data_block,
+						size_t *len)
+{
+	if (data_block->tag != DI_DISPLAYID_DATA_BLOCK_TYPE_I_TIMING) {
+		*len = 0;
+		return NULL;
+	}
+	*len = data_block->type_i_timings_len;
+	return data_block->type_i_timings;
 }
 
 const struct di_displayid_data_block *const *
@@ -454,3 +539,11 @@ di_displayid_get_data_blocks(const struct di_displayid *displayid)
 {
 	return (const struct di_displayid_data_block *const *) displayid->data_blocks;
 }
+
+const struct di_displayid_data_block *const *
+di_displayid_get_data_blocks_span(const struct di_displayid *displayid,
+				  size_t *len)
+{
+	*len = displayid->data_blocks_len;
+	return di_displayid_get_data_blocks(displayid);
+}
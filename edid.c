@@ -7,12 +7,9 @@
 #include "bits.h"
 #include "dmt.h"
 #include "edid.h"
+#include "hash.h"
 #include "log.h"
 
-/**
- * The size of an EDID block, defined in section 2.2.
- */
-#define EDID_BLOCK_SIZE 128
 /**
  * The size of an EDID standard timing, defined in section 3.9.
  */
@@ -24,29 +21,52 @@
 static const uint8_t header[] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
 
 static void
-add_failure(struct di_edid *edid, const char fmt[], ...)
+emit_failure(struct di_edid *edid, enum di_failure_code code,
+	     uintmax_t arg0, uintmax_t arg1, uintmax_t arg2)
 {
-	va_list args;
+	const uintmax_t args[DI_LOG_MAX_ARGS] = { arg0, arg1, arg2 };
+
+	if (!edid->logger) {
+		return;
+	}
 
-	va_start(args, fmt);
-	_di_logger_va_add_failure(edid->logger, fmt, args);
-	va_end(args);
+	_di_logger_add_failure(edid->logger, code, args);
 }
 
 static void
-add_failure_until(struct di_edid *edid, int revision, const char fmt[], ...)
+emit_failure_until(struct di_edid *edid, int revision,
+		   enum di_failure_code code,
+		   uintmax_t arg0, uintmax_t arg1, uintmax_t arg2)
 {
-	va_list args;
-
 	if (edid->revision > revision) {
 		return;
 	}
 
-	va_start(args, fmt);
-	_di_logger_va_add_failure(edid->logger, fmt, args);
-	va_end(args);
+	emit_failure(edid, code, arg0, arg1, arg2);
 }
 
+/* The failure code is followed by up to DI_LOG_MAX_ARGS integer arguments of
+ * its message, the missing ones are zero. Failures below the
+ * min_failure_severity build option compile away, along with the evaluation
+ * of their arguments. */
+#define add_failure(edid, ...) \
+	add_failure_args(edid, __VA_ARGS__, 0, 0, 0, 0)
+
+#define add_failure_args(edid, code, arg0, arg1, arg2, ...) \
+	do { \
+		if (DI_FAILURE_ENABLED(code)) \
+			emit_failure(edid, code, arg0, arg1, arg2); \
+	} while (0)
+
+#define add_failure_until(edid, revision, ...) \
+	add_failure_until_args(edid, revision, __VA_ARGS__, 0, 0, 0, 0)
+
+#define add_failure_until_args(edid, revision, code, arg0, arg1, arg2, ...) \
+	do { \
+		if (DI_FAILURE_ENABLED(code)) \
+			emit_failure_until(edid, revision, code, arg0, arg1, arg2); \
+	} while (0)
+
 static void
 parse_version_revision(const uint8_t data[static_array EDID_BLOCK_SIZE],
 		       int *version, int *revision)
@@ -61,8 +81,8 @@ parse_ext_count(const uint8_t data[static_array EDID_BLOCK_SIZE])
 	return data[0x7E];
 }
 
-static bool
-validate_block_checksum(const uint8_t data[static_array EDID_BLOCK_SIZE])
+bool
+_di_edid_validate_block_checksum(const uint8_t data[static_array EDID_BLOCK_SIZE])
 {
 	uint8_t sum = 0;
 	size_t i;
@@ -75,10 +95,10 @@ validate_block_checksum(const uint8_t data[static_array EDID_BLOCK_SIZE])
 }
 
 static void
-parse_vendor_product(struct di_edid *edid,
-		     const uint8_t data[static_array EDID_BLOCK_SIZE])
+decode_vendor_product(int revision,
+		      const uint8_t data[static_array EDID_BLOCK_SIZE],
+		      struct di_edid_vendor_product *out)
 {
-	struct di_edid_vendor_product *out = &edid->vendor_product;
 	uint16_t man, raw_week, raw_year;
 	int year = 0;
 
@@ -97,10 +117,8 @@ parse_vendor_product(struct di_edid *edid,
 	raw_week = data[0x10];
 	raw_year = data[0x11];
 
-	if (raw_year >= 0x10 || edid->revision < 4) {
+	if (raw_year >= 0x10 || revision < 4) {
 		year = data[0x11] + 1990;
-	} else if (edid->revision == 4) {
-		add_failure(edid, "Year set to reserved value.");
 	}
 
 	if (raw_week == 0xFF) {
@@ -108,16 +126,33 @@ parse_vendor_product(struct di_edid *edid,
 		out->model_year = year;
 	} else {
 		out->manufacture_year = year;
-		if (raw_week > 54) {
-			add_failure_until(edid, 4,
-					  "Invalid week %u of manufacture.",
-					  raw_week);
-		} else if (raw_week > 0) {
+		if (raw_week > 0 && raw_week <= 54) {
 			out->manufacture_week = raw_week;
 		}
 	}
 }
 
+static void
+parse_vendor_product(struct di_edid *edid,
+		     const uint8_t data[static_array EDID_BLOCK_SIZE])
+{
+	uint8_t raw_week, raw_year;
+
+	decode_vendor_product(edid->revision, data, &edid->vendor_product);
+
+	raw_week = data[0x10];
+	raw_year = data[0x11];
+
+	if (raw_year < 0x10 && edid->revision == 4) {
+		add_failure(edid, DI_FAILURE_EDID_RESERVED_YEAR);
+	}
+
+	if (raw_week != 0xFF && raw_week > 54) {
+		add_failure_until(edid, 4, DI_FAILURE_EDID_INVALID_WEEK,
+				  raw_week);
+	}
+}
+
 static void
 parse_video_input_digital(struct di_edid *edid, uint8_t video_input)
 {
@@ -126,13 +161,13 @@ parse_video_input_digital(struct di_edid *edid, uint8_t video_input)
 
 	if (edid->revision < 2) {
 		if (get_bit_range(video_input, 6, 0) != 0)
-			add_failure(edid, "Digital Video Interface Standard set to reserved value 0x%02x.",
+			add_failure(edid, DI_FAILURE_EDID_RESERVED_VIDEO_INTERFACE,
 				    video_input);
 		return;
 	}
 	if (edid->revision < 4) {
 		if (get_bit_range(video_input, 6, 1) != 0)
-			add_failure(edid, "Digital Video Interface Standard set to reserved value 0x%02x.",
+			add_failure(edid, DI_FAILURE_EDID_RESERVED_VIDEO_INTERFACE,
 				    video_input);
 		digital->dfp1 = has_bit(video_input, 0);
 		return;
@@ -141,7 +176,7 @@ parse_video_input_digital(struct di_edid *edid, uint8_t video_input)
 	color_bit_depth = get_bit_range(video_input, 6, 4);
 	if (color_bit_depth == 0x07) {
 		/* Reserved */
-		add_failure_until(edid, 4, "Color Bit Depth set to reserved value.");
+		add_failure_until(edid, 4, DI_FAILURE_EDID_RESERVED_COLOR_BIT_DEPTH);
 	} else if (color_bit_depth != 0) {
 		digital->color_bit_depth = 2 * color_bit_depth + 4;
 	}
@@ -157,8 +192,7 @@ parse_video_input_digital(struct di_edid *edid, uint8_t video_input)
 		digital->interface = interface;
 		break;
 	default:
-		add_failure_until(edid, 4,
-				  "Digital Video Interface Standard set to reserved value 0x%02x.",
+		add_failure_until(edid, 4, DI_FAILURE_EDID_RESERVED_VIDEO_INTERFACE,
 				  interface);
 		digital->interface = DI_EDID_VIDEO_INPUT_DIGITAL_UNDEFINED;
 		break;
@@ -179,20 +213,11 @@ parse_video_input_analog(struct di_edid *edid, uint8_t video_input)
 }
 
 static void
-parse_basic_params_features(struct di_edid *edid,
-			    const uint8_t data[static_array EDID_BLOCK_SIZE])
+decode_screen_size(int revision,
+		   const uint8_t data[static_array EDID_BLOCK_SIZE],
+		   struct di_edid_screen_size *screen_size)
 {
-	uint8_t video_input, width, height, features;
-	struct di_edid_screen_size *screen_size = &edid->screen_size;
-
-	video_input = data[0x14];
-	edid->is_digital = has_bit(video_input, 7);
-
-	if (edid->is_digital) {
-		parse_video_input_digital(edid, video_input);
-	} else {
-		parse_video_input_analog(edid, video_input);
-	}
+	uint8_t width, height;
 
 	/* v1.3 says screen size is undefined if either byte is zero, v1.4 says
 	 * screen size and aspect ratio are undefined if both bytes are zero and
@@ -202,13 +227,31 @@ parse_basic_params_features(struct di_edid *edid,
 	if (width > 0 && height > 0) {
 		screen_size->width_cm = width;
 		screen_size->height_cm = height;
-	} else if (edid->revision >= 4) {
+	} else if (revision >= 4) {
 		if (width > 0) {
 			screen_size->landscape_aspect_ratio = ((float) width + 99) / 100;
 		} else if (height > 0) {
 			screen_size->portait_aspect_ratio = ((float) height + 99) / 100;
 		}
 	}
+}
+
+static void
+parse_basic_params_features(struct di_edid *edid,
+			    const uint8_t data[static_array EDID_BLOCK_SIZE])
+{
+	uint8_t video_input, features;
+
+	video_input = data[0x14];
+	edid->is_digital = has_bit(video_input, 7);
+
+	if (edid->is_digital) {
+		parse_video_input_digital(edid, video_input);
+	} else {
+		parse_video_input_analog(edid, video_input);
+	}
+
+	decode_screen_size(edid->revision, data, &edid->screen_size);
 
 	if (data[0x17] != 0xFF) {
 		edid->gamma = ((float) data[0x17] + 100) / 100;
@@ -252,14 +295,10 @@ decode_chromaticity_coord(uint8_t hi, uint8_t lo)
 }
 
 static void
-parse_chromaticity_coords(struct di_edid *edid,
-			  const uint8_t data[static_array EDID_BLOCK_SIZE])
+decode_chromaticity_coords(const uint8_t data[static_array EDID_BLOCK_SIZE],
+			   struct di_edid_chromaticity_coords *coords)
 {
 	uint8_t lo;
-	bool all_set, any_set;
-	struct di_edid_chromaticity_coords *coords;
-
-	coords = &edid->chromaticity_coords;
 
 	lo = data[0x19];
 	coords->red_x = decode_chromaticity_coord(data[0x1B], get_bit_range(lo, 7, 6));
@@ -272,6 +311,17 @@ parse_chromaticity_coords(struct di_edid *edid,
 	coords->blue_y = decode_chromaticity_coord(data[0x20], get_bit_range(lo, 5, 4));
 	coords->white_x = decode_chromaticity_coord(data[0x21], get_bit_range(lo, 3, 2));
 	coords->white_y = decode_chromaticity_coord(data[0x22], get_bit_range(lo, 1, 0));
+}
+
+static void
+parse_chromaticity_coords(struct di_edid *edid,
+			  const uint8_t data[static_array EDID_BLOCK_SIZE])
+{
+	bool all_set, any_set;
+	struct di_edid_chromaticity_coords *coords;
+
+	coords = &edid->chromaticity_coords;
+	decode_chromaticity_coords(data, coords);
 
 	/* Either all primaries coords must be set, either none must be set */
 	any_set = coords->red_x != 0 || coords->red_y != 0
@@ -281,12 +331,12 @@ parse_chromaticity_coords(struct di_edid *edid,
 		  && coords->green_x != 0 && coords->green_y != 0
 		  && coords->blue_x != 0 && coords->blue_y != 0;
 	if (any_set && !all_set) {
-		add_failure(edid, "Some but not all primaries coordinates are unset.");
+		add_failure(edid, DI_FAILURE_EDID_PARTIAL_PRIMARIES);
 	}
 
 	/* Both white-point coords must be set */
 	if (coords->white_x == 0 || coords->white_y == 0) {
-		add_failure(edid, "White-point coordinates are unset.");
+		add_failure(edid, DI_FAILURE_EDID_UNSET_WHITE_POINT);
 	}
 }
 
@@ -319,28 +369,21 @@ parse_established_timings_i_ii(struct di_edid *edid,
 	/* TODO: manufacturer specified timings in bits 6:0 */
 }
 
+/**
+ * Parse a standard timing into t. Returns false if the timing is unused.
+ */
 static bool
 parse_standard_timing(struct di_edid *edid,
 		      const uint8_t data[static_array EDID_STANDARD_TIMING_SIZE],
-		      struct di_edid_standard_timing **out)
+		      struct di_edid_standard_timing *t)
 {
-	struct di_edid_standard_timing *t;
-
-	*out = NULL;
-
 	if (data[0] == 0x01 && data[1] == 0x01) {
 		/* Unused */
-		return true;
+		return false;
 	}
 	if (data[0] == 0x00) {
-		add_failure_until(edid, 4,
-				  "Use 0x0101 as the invalid Standard Timings code, not 0x%02x%02x.",
+		add_failure_until(edid, 4, DI_FAILURE_EDID_INVALID_STANDARD_TIMING_CODE,
 				  data[0], data[1]);
-		return true;
-	}
-
-	t = calloc(1, sizeof(*t));
-	if (!t) {
 		return false;
 	}
 
@@ -348,29 +391,24 @@ parse_standard_timing(struct di_edid *edid,
 	t->aspect_ratio = get_bit_range(data[1], 7, 6);
 	t->refresh_rate_hz = (int32_t) get_bit_range(data[1], 5, 0) + 60;
 
-	*out = t;
 	return true;
 }
 
-struct di_edid_detailed_timing_def_priv *
-_di_edid_parse_detailed_timing_def(const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE])
+/**
+ * Decode a detailed timing definition. The flags of the signal type are
+ * stored in the matching struct, which def then references.
+ */
+static void
+decode_detailed_timing_def(const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE],
+			   struct di_edid_detailed_timing_def *def,
+			   struct di_edid_detailed_timing_analog_composite *analog_composite,
+			   struct di_edid_detailed_timing_bipolar_analog_composite *bipolar_analog_composite,
+			   struct di_edid_detailed_timing_digital_composite *digital_composite,
+			   struct di_edid_detailed_timing_digital_separate *digital_separate)
 {
-	struct di_edid_detailed_timing_def_priv *priv;
-	struct di_edid_detailed_timing_def *def;
-	struct di_edid_detailed_timing_analog_composite *analog_composite;
-	struct di_edid_detailed_timing_bipolar_analog_composite *bipolar_analog_composite;
-	struct di_edid_detailed_timing_digital_composite *digital_composite;
-	struct di_edid_detailed_timing_digital_separate *digital_separate;
 	int raw;
 	uint8_t flags, stereo_hi, stereo_lo;
 
-	priv = calloc(1, sizeof(*priv));
-	if (!priv) {
-		return NULL;
-	}
-
-	def = &priv->base;
-
 	raw = (data[1] << 8) | data[0];
 	def->pixel_clock_hz = raw * 10 * 1000;
 
@@ -437,31 +475,43 @@ _di_edid_parse_detailed_timing_def(const uint8_t data[static_array EDID_BYTE_DES
 
 	switch (def->signal_type) {
 	case DI_EDID_DETAILED_TIMING_DEF_SIGNAL_ANALOG_COMPOSITE:
-		analog_composite = &priv->analog_composite;
 		analog_composite->sync_serrations = has_bit(flags, 2);
 		analog_composite->sync_on_green = has_bit(flags, 1);
 		def->analog_composite = analog_composite;
 		break;
 	case DI_EDID_DETAILED_TIMING_DEF_SIGNAL_BIPOLAR_ANALOG_COMPOSITE:
-		bipolar_analog_composite = &priv->bipolar_analog_composite;
 		bipolar_analog_composite->sync_serrations = has_bit(flags, 2);
 		bipolar_analog_composite->sync_on_green = has_bit(flags, 1);
 		def->bipolar_analog_composite = bipolar_analog_composite;
 		break;
 	case DI_EDID_DETAILED_TIMING_DEF_SIGNAL_DIGITAL_COMPOSITE:
-		digital_composite = &priv->digital_composite;
 		digital_composite->sync_serrations = has_bit(flags, 2);
 		digital_composite->sync_horiz_polarity = has_bit(flags, 1);
 		def->digital_composite = digital_composite;
 		break;
 	case DI_EDID_DETAILED_TIMING_DEF_SIGNAL_DIGITAL_SEPARATE:
-		digital_separate = &priv->digital_separate;
 		digital_separate->sync_vert_polarity = has_bit(flags, 2);
 		digital_separate->sync_horiz_polarity = has_bit(flags, 1);
 		def->digital_separate = digital_separate;
 		break;
 	}
+}
+
+struct di_edid_detailed_timing_def_priv *
+_di_edid_parse_detailed_timing_def(struct di_arena *arena,
+				   const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE])
+{
+	struct di_edid_detailed_timing_def_priv *priv;
+
+	priv = _di_arena_alloc(arena, sizeof(*priv));
+	if (!priv) {
+		return NULL;
+	}
 
+	decode_detailed_timing_def(data, &priv->base, &priv->analog_composite,
+				   &priv->bipolar_analog_composite,
+				   &priv->digital_composite,
+				   &priv->digital_separate);
 	return priv;
 }
 
@@ -481,8 +531,7 @@ decode_display_range_limits_offset(struct di_edid *edid, uint8_t flags,
 		*min_offset = 255;
 		break;
 	default:
-		add_failure_until(edid, 4,
-				  "Range offset flags set to reserved value 0x%02x.",
+		add_failure_until(edid, 4, DI_FAILURE_EDID_RESERVED_RANGE_OFFSET_FLAGS,
 				  flags);
 		return false;
 	}
@@ -526,15 +575,15 @@ parse_display_range_limits(struct di_edid *edid,
 
 		if (edid->revision <= 4 &&
 		    get_bit_range(offset_flags, 7, 4) != 0) {
-			add_failure(edid, "Display Range Limits: Bits 7:4 of the range offset flags are reserved.");
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_RESERVED_OFFSET_BITS);
 		}
 	} else if (offset_flags != 0) {
-		add_failure(edid, "Display Range Limits: Range offset flags are unsupported in EDID 1.3.");
+		add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_OFFSET);
 	}
 
 	if (edid->revision <= 4 && (data[5] == 0 || data[6] == 0 ||
 				    data[7] == 0 || data[8] == 0)) {
-		add_failure(edid, "Display Range Limits: Range limits set to reserved values.");
+		add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_RESERVED);
 		return false;
 	}
 
@@ -544,17 +593,17 @@ parse_display_range_limits(struct di_edid *edid,
 	base->max_horiz_rate_hz = (data[8] + max_horiz_offset) * 1000;
 
 	if (base->min_vert_rate_hz > base->max_vert_rate_hz) {
-		add_failure(edid, "Display Range Limits: Min vertical rate > max vertical rate.");
+		add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_VERT_RATE_ORDER);
 		return false;
 	}
 	if (base->min_horiz_rate_hz > base->max_horiz_rate_hz) {
-		add_failure(edid, "Display Range Limits: Min horizontal freq > max horizontal freq.");
+		add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_HORIZ_FREQ_ORDER);
 		return false;
 	}
 
 	base->max_pixel_clock_hz = (int32_t) data[9] * 10 * 1000 * 1000;
 	if (edid->revision == 4 && base->max_pixel_clock_hz == 0) {
-		add_failure(edid, "Display Range Limits: EDID 1.4 block does not set max dotclock.");
+		add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_NO_MAX_DOTCLOCK);
 	}
 
 	support_flags = data[10];
@@ -572,7 +621,7 @@ parse_display_range_limits(struct di_edid *edid,
 	case 0x01:
 		if (edid->revision < 4) {
 			/* Reserved */
-			add_failure(edid, "Display Range Limits: 'Bare Limits' is not allowed for EDID < 1.4.");
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_BARE_LIMITS);
 			return false;
 		}
 		base->type = DI_EDID_DISPLAY_RANGE_LIMITS_BARE;
@@ -583,7 +632,7 @@ parse_display_range_limits(struct di_edid *edid,
 	case 0x04:
 		if (edid->revision < 4) {
 			/* Reserved */
-			add_failure(edid, "Display Range Limits: 'CVT' is not allowed for EDID < 1.4.");
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_CVT);
 			return false;
 		}
 		base->type = DI_EDID_DISPLAY_RANGE_LIMITS_CVT;
@@ -591,8 +640,7 @@ parse_display_range_limits(struct di_edid *edid,
 	default:
 		/* Reserved */
 		if (edid->revision <= 4) {
-			add_failure(edid,
-				    "Display Range Limits: Unknown range class (0x%02x).",
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_UNKNOWN_CLASS,
 				    support_flags);
 			return false;
 		}
@@ -606,10 +654,10 @@ parse_display_range_limits(struct di_edid *edid,
 		switch (base->type) {
 		case DI_EDID_DISPLAY_RANGE_LIMITS_DEFAULT_GTF:
 		case DI_EDID_DISPLAY_RANGE_LIMITS_SECONDARY_GTF:
-			add_failure(edid, "Display Range Limits: GTF can't be combined with non-continuous frequencies.");
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_GTF_NON_CONTINUOUS);
 			return false;
 		case DI_EDID_DISPLAY_RANGE_LIMITS_CVT:
-			add_failure(edid, "Display Range Limits: CVT can't be combined with non-continuous frequencies.");
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_CVT_NON_CONTINUOUS);
 			return false;
 		default:
 			break;
@@ -621,9 +669,8 @@ parse_display_range_limits(struct di_edid *edid,
 		secondary_gtf = &priv->secondary_gtf;
 
 		if (data[11] != 0)
-			add_failure(edid,
-				    "Display Range Limits: Byte 11 is 0x%02x instead of 0x00.",
-				    data[11]);
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_INVALID_BYTE_11,
+				    data[11], 0x00);
 
 		secondary_gtf->start_freq_hz = data[12] * 2 * 1000;
 		secondary_gtf->c = (float) data[13] / 2;
@@ -644,8 +691,8 @@ parse_display_range_limits(struct di_edid *edid,
 
 		cvt->supported_aspect_ratio = data[14];
 		if (get_bit_range(data[14], 2, 0) != 0)
-			add_failure_until(edid, 4,
-					  "Display Range Limits: Reserved bits of byte 14 are non-zero.");
+			add_failure_until(edid, 4, DI_FAILURE_EDID_RANGE_LIMITS_CVT_RESERVED_BITS,
+					  14);
 
 		preferred_aspect_ratio = get_bit_range(data[15], 7, 5);
 		switch (preferred_aspect_ratio) {
@@ -666,8 +713,7 @@ parse_display_range_limits(struct di_edid *edid,
 			break;
 		default:
 			/* Reserved */
-			add_failure_until(edid, 4,
-					  "Display Range Limits: Invalid preferred aspect ratio 0x%02x.",
+			add_failure_until(edid, 4, DI_FAILURE_EDID_RANGE_LIMITS_CVT_INVALID_ASPECT_RATIO,
 					  preferred_aspect_ratio);
 			return false;
 		}
@@ -676,18 +722,17 @@ parse_display_range_limits(struct di_edid *edid,
 		cvt->reduced_blanking = has_bit(data[15], 4);
 
 		if (get_bit_range(data[15], 2, 0) != 0)
-			add_failure_until(edid, 4,
-					  "Display Range Limits: Reserved bits of byte 15 are non-zero.");
+			add_failure_until(edid, 4, DI_FAILURE_EDID_RANGE_LIMITS_CVT_RESERVED_BITS,
+					  15);
 
 		cvt->supported_scaling = data[16];
 		if (get_bit_range(data[16], 3, 0) != 0)
-			add_failure_until(edid, 4,
-					  "Display Range Limits: Reserved bits of byte 16 are non-zero.");
+			add_failure_until(edid, 4, DI_FAILURE_EDID_RANGE_LIMITS_CVT_RESERVED_BITS,
+					  16);
 
 		cvt->preferred_vert_refresh_hz = data[17];
 		if (cvt->preferred_vert_refresh_hz == 0) {
-			add_failure_until(edid, 4,
-					  "Display Range Limits: Preferred vertical refresh rate must be specified.");
+			add_failure_until(edid, 4, DI_FAILURE_EDID_RANGE_LIMITS_CVT_NO_PREFERRED_REFRESH);
 			return false;
 		}
 
@@ -696,13 +741,11 @@ parse_display_range_limits(struct di_edid *edid,
 	case DI_EDID_DISPLAY_RANGE_LIMITS_BARE:
 	case DI_EDID_DISPLAY_RANGE_LIMITS_DEFAULT_GTF:
 		if (data[11] != 0x0A)
-			add_failure(edid,
-				    "Display Range Limits: Byte 11 is 0x%02x instead of 0x0a.",
-				    data[11]);
+			add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_INVALID_BYTE_11,
+				    data[11], 0x0A);
 		for (i = 12; i < EDID_BYTE_DESCRIPTOR_SIZE; i++) {
 			if (data[i] != 0x20) {
-				add_failure(edid,
-					    "Display Range Limits: Bytes 12-17 must be 0x20.");
+				add_failure(edid, DI_FAILURE_EDID_RANGE_LIMITS_INVALID_PADDING);
 				break;
 			}
 		}
@@ -712,10 +755,10 @@ parse_display_range_limits(struct di_edid *edid,
 	return true;
 }
 
-static bool
+static void
 parse_standard_timings_descriptor(struct di_edid *edid,
 				  const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE],
-				  struct di_edid_display_descriptor *desc)
+				  struct di_edid_display_descriptor_standard_timings *desc)
 {
 	struct di_edid_standard_timing *t;
 	size_t i;
@@ -723,19 +766,14 @@ parse_standard_timings_descriptor(struct di_edid *edid,
 
 	for (i = 0; i < EDID_MAX_DESCRIPTOR_STANDARD_TIMING_COUNT; i++) {
 		timing_data = &data[5 + i * EDID_STANDARD_TIMING_SIZE];
-		if (!parse_standard_timing(edid, timing_data, &t))
-			return false;
-		if (t) {
-			assert(desc->standard_timings_len < EDID_MAX_DESCRIPTOR_STANDARD_TIMING_COUNT);
-			desc->standard_timings[desc->standard_timings_len++] = t;
-		}
+		assert(desc->standard_timings_len < EDID_MAX_DESCRIPTOR_STANDARD_TIMING_COUNT);
+		t = &desc->standard_timings[desc->standard_timings_len];
+		if (parse_standard_timing(edid, timing_data, t))
+			desc->standard_timing_ptrs[desc->standard_timings_len++] = t;
 	}
 
 	if (data[17] != 0x0A)
-		add_failure_until(edid, 4,
-				  "Standard Timing Identifications: Last byte must be a line feed.");
-
-	return true;
+		add_failure_until(edid, 4, DI_FAILURE_EDID_STANDARD_TIMINGS_NO_LINE_FEED);
 }
 
 /**
@@ -814,56 +852,72 @@ get_dmt_timing(uint8_t dmt_id)
 	return NULL;
 }
 
-static void
-parse_established_timings_iii_descriptor(struct di_edid *edid,
-					 const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE],
-					 struct di_edid_display_descriptor *desc)
+static uint64_t
+get_established_timings_iii_mask(const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE],
+				 size_t *count)
 {
 	size_t i, offset, bit;
-	uint8_t dmt_id;
-	const struct di_dmt_timing *t;
-	bool has_zeroes;
-
-	if (edid->revision < 4)
-		add_failure(edid, "Established timings III: Not allowed for EDID < 1.4.");
+	uint64_t mask;
 
+	mask = 0;
+	*count = 0;
 	for (i = 0; i < EDID_MAX_DESCRIPTOR_ESTABLISHED_TIMING_III_COUNT; i++) {
-		dmt_id = established_timings_iii[i];
 		offset = 0x06 + i / 8;
 		bit = 7 - i % 8;
 		assert(offset < EDID_BYTE_DESCRIPTOR_SIZE);
 		if (has_bit(data[offset], bit)) {
-			t = get_dmt_timing(dmt_id);
-			assert(t != NULL);
-			desc->established_timings_iii[desc->established_timings_iii_len++] = t;
+			mask |= (uint64_t) 1 << i;
+			(*count)++;
 		}
 	}
 
+	return mask;
+}
+
+static bool
+parse_established_timings_iii_descriptor(struct di_edid *edid,
+					 const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE],
+					 struct di_edid_display_descriptor_established_timings_iii *desc)
+{
+	size_t i, count;
+	bool has_zeroes;
+
+	if (edid->revision < 4)
+		add_failure(edid, DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_UNSUPPORTED);
+
+	/* The DMT timings are looked up on first access */
+	desc->mask = get_established_timings_iii_mask(data, &count);
+	if (edid->arena) {
+		desc->timings = _di_arena_alloc(edid->arena,
+						(count + 1) * sizeof(*desc->timings));
+		if (!desc->timings)
+			return false;
+	}
+	desc->timings_len = count;
+
 	has_zeroes = get_bit_range(data[11], 3, 0) == 0;
 	for (i = 12; i < EDID_BYTE_DESCRIPTOR_SIZE; i++) {
 		has_zeroes = has_zeroes && data[i] == 0;
 	}
 	if (!has_zeroes) {
-		add_failure_until(edid, 4,
-				  "Established timings III: Reserved bits must be set to zero.");
+		add_failure_until(edid, 4, DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_RESERVED_BITS);
 	}
+
+	return true;
 }
 
-static bool
+static void
 parse_color_point_descriptor(struct di_edid *edid,
 			     const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE],
-			     struct di_edid_display_descriptor *desc)
+			     struct di_edid_display_descriptor_color_points *desc)
 {
 	struct di_edid_color_point *c;
 
 	if (data[5] == 0) {
-		add_failure(edid, "White Point Index Number set to reserved value 0");
+		add_failure(edid, DI_FAILURE_EDID_RESERVED_WHITE_POINT_INDEX);
 	}
 
-	c = calloc(1, sizeof(*c));
-	if (!c) {
-		return false;
-	}
+	c = &desc->color_points[desc->color_points_len];
 
 	c->index = data[5];
 	c->white_x = decode_chromaticity_coord(data[7], get_bit_range(data[6], 3, 2));
@@ -873,15 +927,12 @@ parse_color_point_descriptor(struct di_edid *edid,
 		c->gamma = ((float) data[9] + 100) / 100;
 	}
 
-	desc->color_points[desc->color_points_len++] = c;
+	desc->color_point_ptrs[desc->color_points_len++] = c;
 	if (data[10] == 0)  {
-		return true;
+		return;
 	}
 
-	c = calloc(1, sizeof(*c));
-	if (!c) {
-		return false;
-	}
+	c = &desc->color_points[desc->color_points_len];
 
 	c->index = data[10];
 	c->white_x = decode_chromaticity_coord(data[12], get_bit_range(data[11], 3, 2));
@@ -891,14 +942,13 @@ parse_color_point_descriptor(struct di_edid *edid,
 		c->gamma = ((float) data[14] + 100) / 100;
 	}
 
-	desc->color_points[desc->color_points_len++] = c;
-	return true;
+	desc->color_point_ptrs[desc->color_points_len++] = c;
 }
 
 static void
 parse_color_management_data_descriptor(struct di_edid *edid,
 				       const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE],
-				       struct di_edid_display_descriptor *desc)
+				       struct di_edid_display_descriptor_dcm_data *desc)
 {
 	desc->dcm_data.version = data[5];
 
@@ -910,8 +960,34 @@ parse_color_management_data_descriptor(struct di_edid *edid,
 	desc->dcm_data.blue_a2 = (uint16_t)(data[16] | (data[17] << 8)) / 100.0f;
 
 	if (desc->dcm_data.version != 3) {
-		add_failure_until(edid, 4,
-				  "Color Management Data version must be 3");
+		add_failure_until(edid, 4, DI_FAILURE_EDID_INVALID_COLOR_MANAGEMENT_VERSION);
+	}
+}
+
+/**
+ * Get the size of the struct holding a display descriptor with the provided
+ * tag.
+ */
+static size_t
+get_display_descriptor_size(uint8_t tag)
+{
+	switch (tag) {
+	case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_SERIAL:
+	case DI_EDID_DISPLAY_DESCRIPTOR_DATA_STRING:
+	case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_NAME:
+		return sizeof(struct di_edid_display_descriptor_string);
+	case DI_EDID_DISPLAY_DESCRIPTOR_RANGE_LIMITS:
+		return sizeof(struct di_edid_display_descriptor_range_limits);
+	case DI_EDID_DISPLAY_DESCRIPTOR_STD_TIMING_IDS:
+		return sizeof(struct di_edid_display_descriptor_standard_timings);
+	case DI_EDID_DISPLAY_DESCRIPTOR_ESTABLISHED_TIMINGS_III:
+		return sizeof(struct di_edid_display_descriptor_established_timings_iii);
+	case DI_EDID_DISPLAY_DESCRIPTOR_COLOR_POINT:
+		return sizeof(struct di_edid_display_descriptor_color_points);
+	case DI_EDID_DISPLAY_DESCRIPTOR_DCM_DATA:
+		return sizeof(struct di_edid_display_descriptor_dcm_data);
+	default:
+		return sizeof(struct di_edid_display_descriptor);
 	}
 }
 
@@ -920,7 +996,16 @@ parse_byte_descriptor(struct di_edid *edid,
 		      const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE])
 {
 	struct di_edid_display_descriptor *desc;
+	struct di_edid_display_descriptor_string *desc_str;
 	struct di_edid_detailed_timing_def_priv *detailed_timing_def;
+	union {
+		struct di_edid_display_descriptor_string str;
+		struct di_edid_display_descriptor_range_limits range_limits;
+		struct di_edid_display_descriptor_standard_timings standard_timings;
+		struct di_edid_display_descriptor_established_timings_iii established_timings_iii;
+		struct di_edid_display_descriptor_color_points color_points;
+		struct di_edid_display_descriptor_dcm_data dcm_data;
+	} scratch;
 	uint8_t tag;
 	char *newline;
 
@@ -928,120 +1013,191 @@ parse_byte_descriptor(struct di_edid *edid,
 		if (edid->display_descriptors_len > 0) {
 			/* A detailed timing descriptor is not allowed after a
 			 * display descriptor per note 3 of table 3.20. */
-			add_failure(edid, "Invalid detailed timing descriptor ordering.");
-		}
-
-		detailed_timing_def = _di_edid_parse_detailed_timing_def(data);
-		if (!detailed_timing_def) {
-			return false;
+			add_failure(edid, DI_FAILURE_EDID_INVALID_DESCRIPTOR_ORDERING);
 		}
 
 		assert(edid->detailed_timing_defs_len < EDID_BYTE_DESCRIPTOR_COUNT);
-		edid->detailed_timing_defs[edid->detailed_timing_defs_len++] = detailed_timing_def;
+		/* Decoding a detailed timing definition can't fail, so there is
+		 * nothing to do when only validating */
+		if (edid->arena) {
+			detailed_timing_def = _di_edid_parse_detailed_timing_def(edid->arena,
+										 data);
+			if (!detailed_timing_def) {
+				return false;
+			}
+			edid->detailed_timing_defs[edid->detailed_timing_defs_len] = detailed_timing_def;
+		}
+		edid->detailed_timing_defs_len++;
 		return true;
 	}
 
 	if (edid->revision >= 3 && edid->revision <= 4 &&
 	    edid->detailed_timing_defs_len == 0) {
 		/* Per section 3.10.1 */
-		add_failure(edid,
-			    "The first byte descriptor must contain the preferred timing.");
+		add_failure(edid, DI_FAILURE_EDID_NO_PREFERRED_TIMING);
 	}
 
-	desc = calloc(1, sizeof(*desc));
-	if (!desc) {
-		return false;
+	tag = data[3];
+	/* When only validating, the descriptor is decoded on the stack and
+	 * dropped */
+	if (edid->arena) {
+		desc = _di_arena_alloc(edid->arena, get_display_descriptor_size(tag));
+		if (!desc) {
+			return false;
+		}
+	} else {
+		memset(&scratch, 0, sizeof(scratch));
+		desc = (struct di_edid_display_descriptor *) &scratch;
 	}
 
-	tag = data[3];
 	switch (tag) {
 	case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_SERIAL:
 	case DI_EDID_DISPLAY_DESCRIPTOR_DATA_STRING:
 	case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_NAME:
-		memcpy(desc->str, &data[5], 13);
+		desc_str = (struct di_edid_display_descriptor_string *) desc;
+		memcpy(desc_str->str, &data[5], 13);
 
 		/* A newline (if any) indicates the end of the string. */
-		newline = strchr(desc->str, '\n');
+		newline = strchr(desc_str->str, '\n');
 		if (newline) {
 			newline[0] = '\0';
 		}
 		break;
 	case DI_EDID_DISPLAY_DESCRIPTOR_RANGE_LIMITS:
-		if (!parse_display_range_limits(edid, data, &desc->range_limits)) {
-			free(desc);
+		if (!parse_display_range_limits(edid, data,
+						&((struct di_edid_display_descriptor_range_limits *) desc)->range_limits)) {
 			return true;
 		}
 		break;
 	case DI_EDID_DISPLAY_DESCRIPTOR_STD_TIMING_IDS:
-		if (!parse_standard_timings_descriptor(edid, data, desc)) {
-			free(desc);
-			return false;
-		}
+		parse_standard_timings_descriptor(edid, data,
+						  (struct di_edid_display_descriptor_standard_timings *) desc);
 		break;
 	case DI_EDID_DISPLAY_DESCRIPTOR_ESTABLISHED_TIMINGS_III:
-		parse_established_timings_iii_descriptor(edid, data, desc);
-		break;
-	case DI_EDID_DISPLAY_DESCRIPTOR_COLOR_POINT:
-		if (!parse_color_point_descriptor(edid, data, desc)) {
-			free(desc);
+		if (!parse_established_timings_iii_descriptor(edid, data,
+							      (struct di_edid_display_descriptor_established_timings_iii *) desc)) {
 			return false;
 		}
 		break;
+	case DI_EDID_DISPLAY_DESCRIPTOR_COLOR_POINT:
+		parse_color_point_descriptor(edid, data,
+					     (struct di_edid_display_descriptor_color_points *) desc);
+		break;
 	case DI_EDID_DISPLAY_DESCRIPTOR_DCM_DATA:
-		parse_color_management_data_descriptor(edid, data, desc);
+		parse_color_management_data_descriptor(edid, data,
+						       (struct di_edid_display_descriptor_dcm_data *) desc);
 		break;
 	case DI_EDID_DISPLAY_DESCRIPTOR_CVT_TIMING_CODES:
 	case DI_EDID_DISPLAY_DESCRIPTOR_DUMMY:
 		break; /* Ignore */
 	default:
-		free(desc);
 		if (tag <= 0x0F) {
 			/* Manufacturer-specific */
 		} else {
-			add_failure_until(edid, 4, "Unknown Type 0x%02hhx.", tag);
+			add_failure_until(edid, 4, DI_FAILURE_EDID_UNKNOWN_DISPLAY_DESCRIPTOR,
+					  tag);
 		}
 		return true;
 	}
 
 	desc->tag = tag;
 	assert(edid->display_descriptors_len < EDID_BYTE_DESCRIPTOR_COUNT);
-	edid->display_descriptors[edid->display_descriptors_len++] = desc;
+	if (edid->arena)
+		edid->display_descriptors[edid->display_descriptors_len] = desc;
+	edid->display_descriptors_len++;
 	return true;
 }
 
+/**
+ * Get the position of the next failure in the destination of the logger: a
+ * byte offset in a buffer, or an index in records.
+ */
+static size_t
+get_failure_msg_pos(const struct di_edid *edid)
+{
+	const struct di_logger *logger = edid->logger;
+
+	if (!logger)
+		return 0;
+	if (logger->buf)
+		return logger->buf->len;
+	if (logger->records)
+		return logger->records->len;
+	return 0;
+}
+
+/**
+ * Get the position of the next failure code.
+ */
+static size_t
+get_failures_pos(const struct di_edid *edid)
+{
+	const struct di_logger *logger = edid->logger;
+
+	if (!logger || !logger->failures)
+		return 0;
+	return logger->failures->len;
+}
+
+/**
+ * Initialize the logger of an extension block section.
+ */
+static struct di_logger *
+init_ext_logger(struct di_edid *edid, struct di_logger *logger,
+		const char *section)
+{
+	if (!edid->logger)
+		return NULL;
+
+	*logger = (struct di_logger) {
+		.buf = edid->logger->buf,
+		.records = edid->logger->records,
+		.failures = edid->logger->failures,
+		.block_index = edid->exts_len + 1,
+		.section = section,
+		.min_severity = edid->logger->min_severity,
+	};
+	return logger;
+}
+
 static bool
-parse_ext(struct di_edid *edid, const uint8_t data[static_array EDID_BLOCK_SIZE])
+parse_ext(struct di_edid *edid, size_t block_index,
+	  const uint8_t data[static_array EDID_BLOCK_SIZE])
 {
 	struct di_edid_ext *ext;
+	struct di_edid_ext_cta *ext_cta;
+	struct di_edid_ext_displayid *ext_displayid;
 	uint8_t tag;
-	struct di_logger logger;
-	char section_name[64];
+	struct di_logger logger, *ext_logger;
+	struct di_edid_failure_msg_range range = {0};
+	size_t used, failure_msg_start, failure_msg_end, failures_start;
 
-	if (!validate_block_checksum(data)) {
+	if (!_di_edid_validate_block_checksum(data)) {
 		errno = EINVAL;
 		return false;
 	}
 
-	ext = calloc(1, sizeof(*ext));
-	if (!ext) {
-		return false;
-	}
+	used = _di_arena_get_used(edid->arena);
+	failure_msg_start = get_failure_msg_pos(edid);
+	failures_start = get_failures_pos(edid);
 
 	tag = data[0x00];
 	switch (tag) {
 	case DI_EDID_EXT_CEA:
-		snprintf(section_name, sizeof(section_name),
-			 "Block %zu, CTA-861 Extension Block",
-			 edid->exts_len + 1);
-		logger = (struct di_logger) {
-			.f = edid->logger->f,
-			.section = section_name,
-		};
-
-		if (!_di_edid_cta_parse(&ext->cta, data, EDID_BLOCK_SIZE, &logger)) {
-			free(ext);
+		ext_cta = _di_arena_alloc(edid->arena, sizeof(*ext_cta));
+		if (!ext_cta) {
+			return false;
+		}
+		ext = &ext_cta->base;
+
+		ext_logger = init_ext_logger(edid, &logger, "CTA-861 Extension Block");
+
+		if (!_di_edid_cta_parse(&ext_cta->cta, data, EDID_BLOCK_SIZE,
+					edid->arena, ext_logger,
+					edid->skip.cta_data_blocks)) {
 			return false;
 		}
+		edid->cta_parse_size += _di_arena_get_used(edid->arena) - used;
 		break;
 	case DI_EDID_EXT_VTB:
 	case DI_EDID_EXT_DI:
@@ -1050,89 +1206,322 @@ parse_ext(struct di_edid *edid, const uint8_t data[static_array EDID_BLOCK_SIZE]
 	case DI_EDID_EXT_BLOCK_MAP:
 	case DI_EDID_EXT_VENDOR:
 		/* Supported */
+		ext = _di_arena_alloc(edid->arena, sizeof(*ext));
+		if (!ext) {
+			return false;
+		}
 		break;
 	case DI_EDID_EXT_DISPLAYID:
-		snprintf(section_name, sizeof(section_name),
-			 "Block %zu, DisplayID Extension Block",
-			 edid->exts_len + 1);
-		logger = (struct di_logger) {
-			.f = edid->logger->f,
-			.section = section_name,
-		};
-
-		if (!_di_displayid_parse(&ext->displayid, &data[1],
-					 EDID_BLOCK_SIZE - 2, &logger)) {
-			free(ext);
+		ext_displayid = _di_arena_alloc(edid->arena, sizeof(*ext_displayid));
+		if (!ext_displayid) {
 			return false;
 		}
+		ext = &ext_displayid->base;
+
+		ext_logger = init_ext_logger(edid, &logger, "DisplayID Extension Block");
+
+		if (!_di_displayid_parse(&ext_displayid->displayid, &data[1],
+					 EDID_BLOCK_SIZE - 2, edid->arena,
+					 ext_logger, edid->skip.displayid_data_blocks)) {
+			return false;
+		}
+		edid->displayid_parse_size += _di_arena_get_used(edid->arena) - used;
 		break;
 	default:
 		/* Unsupported */
-		free(ext);
-		add_failure_until(edid, 4, "Unknown Extension Block.");
+		add_failure_until(edid, 4, DI_FAILURE_EDID_UNKNOWN_EXTENSION);
 		return true;
 	}
 
 	ext->tag = tag;
-	assert(edid->exts_len < EDID_MAX_BLOCK_COUNT - 1);
+	ext->block_index = block_index;
+	ext->parse_size = _di_arena_get_used(edid->arena) - used;
+	failure_msg_end = get_failure_msg_pos(edid);
+	if (failure_msg_end > failure_msg_start) {
+		/* Leave out the separator from the previous section */
+		if (edid->logger->buf &&
+		    edid->logger->buf->data[failure_msg_start] == '\n')
+			failure_msg_start++;
+		range.start = failure_msg_start;
+		range.len = failure_msg_end - failure_msg_start;
+	}
+	range.failures_start = failures_start;
+	range.failures_len = get_failures_pos(edid) - failures_start;
+	edid->ext_failure_msgs[edid->exts_len] = range;
 	edid->exts[edid->exts_len++] = ext;
 	return true;
 }
 
-struct di_edid *
-_di_edid_parse(const void *data, size_t size, FILE *failure_msg_file)
+/**
+ * Reuse the decoded extension block of a previous parse, if the block at the
+ * same index is identical and would get the same section name.
+ */
+static bool
+reuse_ext(struct di_edid *edid, size_t block_index,
+	  const uint8_t data[static_array EDID_BLOCK_SIZE],
+	  const struct di_edid_reparse_src *src)
 {
-	struct di_edid *edid;
-	struct di_logger logger;
-	int version, revision;
-	size_t exts_len, i;
-	const uint8_t *standard_timing_data, *byte_desc_data, *ext_data;
-	struct di_edid_standard_timing *standard_timing;
+	const uint8_t *old_data;
+	struct di_edid_ext *ext;
+	struct di_edid_failure_msg_range range, new_range = {0};
+	struct di_logger *logger = edid->logger;
+	struct di_failure_list *failures = logger ? logger->failures : NULL;
 
-	if (size < EDID_BLOCK_SIZE ||
-	    size > EDID_MAX_BLOCK_COUNT * EDID_BLOCK_SIZE ||
-	    size % EDID_BLOCK_SIZE != 0) {
-		errno = EINVAL;
-		return NULL;
-	}
+	if (src->size <= block_index * EDID_BLOCK_SIZE ||
+	    src->edid->exts_len <= edid->exts_len)
+		return false;
 
-	if (memcmp(data, header, sizeof(header)) != 0) {
-		errno = EINVAL;
-		return NULL;
-	}
+	/* Section names are numbered by extension, not by block */
+	ext = src->edid->exts[edid->exts_len];
+	if (ext->block_index != block_index)
+		return false;
 
-	parse_version_revision(data, &version, &revision);
-	if (version != 1) {
-		/* Only EDID version 1 is supported -- as per section 2.1.7
-		 * subsequent versions break the structure */
-		errno = ENOTSUP;
-		return NULL;
-	}
+	/* Checking the checksum byte first rejects most changed blocks */
+	old_data = &src->data[block_index * EDID_BLOCK_SIZE];
+	if (old_data[EDID_BLOCK_SIZE - 1] != data[EDID_BLOCK_SIZE - 1] ||
+	    memcmp(old_data, data, EDID_BLOCK_SIZE) != 0)
+		return false;
 
-	if (!validate_block_checksum(data)) {
-		errno = EINVAL;
-		return NULL;
+	range = src->edid->ext_failure_msgs[edid->exts_len];
+
+	/* Once room is made for the codes, copying them can't fail */
+	if (failures && range.failures_len > 0 &&
+	    (!src->failures ||
+	     !_di_failure_list_reserve(failures, range.failures_len)))
+		return false;
+
+	if (range.len > 0 && logger && logger->buf) {
+		/* The previous messages may have been truncated */
+		if (range.start > src->failure_msg_len)
+			range.start = src->failure_msg_len;
+		if (range.len > src->failure_msg_len - range.start)
+			range.len = src->failure_msg_len - range.start;
+
+		if (range.len > 0) {
+			_di_log_buffer_add_section(logger->buf,
+						   &src->failure_msg[range.start],
+						   range.len);
+			new_range.start = logger->buf->len - range.len;
+			new_range.len = range.len;
+		}
+	} else if (range.len > 0 && logger && logger->records) {
+		if (!src->failure_records ||
+		    !_di_log_records_add_section(logger->records,
+						 src->failure_records,
+						 range.start, range.len))
+			return false;
+		new_range.start = logger->records->len - range.len;
+		new_range.len = range.len;
 	}
 
-	exts_len = size / EDID_BLOCK_SIZE - 1;
-	if (exts_len != parse_ext_count(data)) {
-		errno = EINVAL;
-		return NULL;
+	if (failures) {
+		new_range.failures_start = failures->len;
+		if (range.failures_len > 0)
+			_di_failure_list_add_section(failures, src->failures,
+						     range.failures_start,
+						     range.failures_len);
+		new_range.failures_len = failures->len - new_range.failures_start;
 	}
+	edid->ext_failure_msgs[edid->exts_len] = new_range;
 
-	edid = calloc(1, sizeof(*edid));
-	if (!edid) {
-		return NULL;
+	switch (ext->tag) {
+	case DI_EDID_EXT_CEA:
+		edid->cta_parse_size += ext->parse_size;
+		break;
+	case DI_EDID_EXT_DISPLAYID:
+		edid->displayid_parse_size += ext->parse_size;
+		break;
+	default:
+		break;
 	}
 
-	logger = (struct di_logger) {
-		.f = failure_msg_file,
-		.section = "Block 0, Base EDID",
-	};
-	edid->logger = &logger;
+	edid->parse_size += ext->parse_size;
+	edid->exts[edid->exts_len++] = ext;
+	return true;
+}
 
-	edid->version = version;
-	edid->revision = revision;
+/**
+ * Get the logger of the base block, NULL if failures are dropped: the
+ * failures are then not even formatted.
+ */
+static struct di_logger *
+get_base_logger(struct di_edid *edid)
+{
+	const struct di_logger *logger = &edid->base_logger;
+
+	if (!logger->buf && !logger->records && !logger->failures)
+		return NULL;
+	return &edid->base_logger;
+}
+
+static void
+finish_parse(struct di_edid *edid)
+{
+	edid->logger = NULL;
+	edid->arena = NULL;
+}
+
+/**
+ * Decode the extension blocks of a lazy _di_edid_parse().
+ *
+ * This can't fail: decoding stops at the first block which can't be decoded,
+ * and a failure message is logged instead.
+ */
+static void
+decode_lazy_exts(struct di_edid *edid)
+{
+	size_t used, i;
+
+	edid->logger = get_base_logger(edid);
+	used = _di_arena_get_used(edid->arena);
+
+	for (i = 0; i < edid->lazy_exts_count; i++) {
+		if (!parse_ext(edid, i + 1,
+			       &edid->lazy_exts_data[i * EDID_BLOCK_SIZE])) {
+			add_failure(edid, DI_FAILURE_EDID_EXTENSION_DECODE_FAILED,
+				    i + 1, (uintmax_t) errno);
+			break;
+		}
+	}
+
+	edid->parse_size += _di_arena_get_used(edid->arena) - used;
+	finish_parse(edid);
+}
+
+/**
+ * Check the fixed header, the version and the checksum of an EDID base block.
+ */
+static bool
+validate_base_block(const uint8_t data[static_array EDID_BLOCK_SIZE])
+{
+	int version, revision;
+
+	if (memcmp(data, header, sizeof(header)) != 0) {
+		errno = EINVAL;
+		return false;
+	}
+
+	parse_version_revision(data, &version, &revision);
+	if (version != 1) {
+		/* Only EDID version 1 is supported -- as per section 2.1.7
+		 * subsequent versions break the structure */
+		errno = ENOTSUP;
+		return false;
+	}
+
+	if (!_di_edid_validate_block_checksum(data)) {
+		errno = EINVAL;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Check the fixed header, the version, the base block checksum and the
+ * extension count of an EDID blob.
+ */
+static bool
+validate_edid(const void *data, size_t size)
+{
+	if (size < EDID_BLOCK_SIZE ||
+	    size > EDID_MAX_BLOCK_COUNT * EDID_BLOCK_SIZE ||
+	    size % EDID_BLOCK_SIZE != 0) {
+		errno = EINVAL;
+		return false;
+	}
+
+	if (!validate_base_block(data))
+		return false;
+
+	if (size / EDID_BLOCK_SIZE - 1 != parse_ext_count(data)) {
+		errno = EINVAL;
+		return false;
+	}
+
+	return true;
+}
+
+static size_t
+get_byte_descriptor_parse_size(const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE])
+{
+	size_t size, count;
+
+	if (data[0] || data[1])
+		return _di_arena_get_alloc_size(sizeof(struct di_edid_detailed_timing_def_priv));
+
+	size = _di_arena_get_alloc_size(get_display_descriptor_size(data[3]));
+	switch (data[3]) {
+	case DI_EDID_DISPLAY_DESCRIPTOR_ESTABLISHED_TIMINGS_III:
+		get_established_timings_iii_mask(data, &count);
+		size += _di_arena_get_alloc_size((count + 1)
+						 * sizeof(const struct di_dmt_timing *));
+		break;
+	default:
+		break;
+	}
+	return size;
+}
+
+static size_t
+get_ext_parse_size(const uint8_t data[static_array EDID_BLOCK_SIZE])
+{
+	switch (data[0x00]) {
+	case DI_EDID_EXT_CEA:
+		return _di_arena_get_alloc_size(sizeof(struct di_edid_ext_cta))
+		       + _di_edid_cta_get_parse_size(data, EDID_BLOCK_SIZE);
+	case DI_EDID_EXT_DISPLAYID:
+		return _di_arena_get_alloc_size(sizeof(struct di_edid_ext_displayid))
+		       + _di_displayid_get_parse_size(&data[1], EDID_BLOCK_SIZE - 2);
+	case DI_EDID_EXT_VTB:
+	case DI_EDID_EXT_DI:
+	case DI_EDID_EXT_LS:
+	case DI_EDID_EXT_DPVL:
+	case DI_EDID_EXT_BLOCK_MAP:
+	case DI_EDID_EXT_VENDOR:
+		return _di_arena_get_alloc_size(sizeof(struct di_edid_ext));
+	default:
+		return 0; /* Unsupported, skipped */
+	}
+}
+
+size_t
+_di_edid_get_parse_size(const void *data, size_t size)
+{
+	size_t parse_size, i;
+	const uint8_t *raw = data;
+
+	if (!validate_edid(data, size))
+		return 0;
+
+	parse_size = _di_arena_get_alloc_size(sizeof(struct di_edid));
+	parse_size += _di_arena_get_alloc_size(size / EDID_BLOCK_SIZE
+					       * sizeof(struct di_edid_ext *));
+	parse_size += _di_arena_get_alloc_size((size / EDID_BLOCK_SIZE - 1)
+					       * sizeof(struct di_edid_failure_msg_range));
+
+	for (i = 0; i < EDID_BYTE_DESCRIPTOR_COUNT; i++)
+		parse_size += get_byte_descriptor_parse_size(&raw[0x36 + i * EDID_BYTE_DESCRIPTOR_SIZE]);
+
+	for (i = EDID_BLOCK_SIZE; i < size; i += EDID_BLOCK_SIZE)
+		parse_size += get_ext_parse_size(&raw[i]);
+
+	return parse_size;
+}
+
+/**
+ * Decode the fields of an EDID base block into edid.
+ *
+ * If the arena of edid is NULL, the base block is only validated: failures are
+ * reported, but the byte descriptors are not stored.
+ */
+static bool
+decode_base_block(struct di_edid *edid,
+		  const uint8_t data[static_array EDID_BLOCK_SIZE])
+{
+	size_t i;
+	const uint8_t *standard_timing_data, *byte_desc_data;
+	struct di_edid_standard_timing *standard_timing;
 
 	parse_vendor_product(edid, data);
 	parse_basic_params_features(edid, data);
@@ -1141,91 +1530,181 @@ _di_edid_parse(const void *data, size_t size, FILE *failure_msg_file)
 	parse_established_timings_i_ii(edid, data);
 
 	for (i = 0; i < EDID_MAX_STANDARD_TIMING_COUNT; i++) {
-		standard_timing_data = (const uint8_t *) data
-				       + 0x26 + i * EDID_STANDARD_TIMING_SIZE;
-		if (!parse_standard_timing(edid, standard_timing_data,
-					   &standard_timing)) {
-			_di_edid_destroy(edid);
-			return NULL;
-		}
-		if (standard_timing) {
-			assert(edid->standard_timings_len < EDID_MAX_STANDARD_TIMING_COUNT);
-			edid->standard_timings[edid->standard_timings_len++] = standard_timing;
-		}
+		standard_timing_data = data + 0x26 + i * EDID_STANDARD_TIMING_SIZE;
+		assert(edid->standard_timings_len < EDID_MAX_STANDARD_TIMING_COUNT);
+		standard_timing = &edid->standard_timings[edid->standard_timings_len];
+		if (parse_standard_timing(edid, standard_timing_data,
+					  standard_timing))
+			edid->standard_timing_ptrs[edid->standard_timings_len++] = standard_timing;
 	}
 
-	for (i = 0; i < EDID_BYTE_DESCRIPTOR_COUNT; i++) {
-		byte_desc_data = (const uint8_t *) data
-			       + 0x36 + i * EDID_BYTE_DESCRIPTOR_SIZE;
+	/* Skipped descriptors are covered by the base block checksum */
+	for (i = 0; i < EDID_BYTE_DESCRIPTOR_COUNT && !edid->skip.base_descriptors; i++) {
+		byte_desc_data = data + 0x36 + i * EDID_BYTE_DESCRIPTOR_SIZE;
 		if (!parse_byte_descriptor(edid, byte_desc_data)) {
-			_di_edid_destroy(edid);
-			return NULL;
+			return false;
 		}
 	}
 
+	return true;
+}
+
+/**
+ * Decode the base block of an EDID blob. The extension blocks are then decoded
+ * with parse_ext(), and the logger and the arena are released by
+ * finish_parse().
+ */
+static struct di_edid *
+parse_base_block(struct di_arena *arena,
+		 const uint8_t data[static_array EDID_BLOCK_SIZE],
+		 const struct di_logger *logger,
+		 const struct di_edid_skip *skip)
+{
+	struct di_edid *edid;
+	int version, revision;
+	size_t exts_len, used;
+
+	parse_version_revision(data, &version, &revision);
+	exts_len = parse_ext_count(data);
+
+	used = _di_arena_get_used(arena);
+	edid = _di_arena_alloc(arena, sizeof(*edid));
+	if (!edid) {
+		return NULL;
+	}
+
+	edid->base_logger = (struct di_logger) {
+		.block_index = 0,
+		.section = "Base EDID",
+	};
+	if (logger) {
+		edid->base_logger.buf = logger->buf;
+		edid->base_logger.records = logger->records;
+		edid->base_logger.failures = logger->failures;
+		edid->base_logger.min_severity = logger->min_severity;
+	}
+	edid->logger = get_base_logger(edid);
+	edid->arena = arena;
+	if (skip)
+		edid->skip = *skip;
+
+	edid->version = version;
+	edid->revision = revision;
+
+	edid->exts = _di_arena_alloc(arena, (exts_len + 1) * sizeof(*edid->exts));
+	if (!edid->exts) {
+		return NULL;
+	}
+	edid->ext_failure_msgs = _di_arena_alloc(arena, exts_len * sizeof(*edid->ext_failure_msgs));
+	if (!edid->ext_failure_msgs) {
+		return NULL;
+	}
+
+	if (!decode_base_block(edid, data)) {
+		return NULL;
+	}
+
+	edid->parse_size = _di_arena_get_used(arena) - used;
+	return edid;
+}
+
+static struct di_edid *
+parse_edid(struct di_arena *arena, const void *data, size_t size,
+	   const struct di_logger *logger, bool lazy, const struct di_edid_skip *skip,
+	   const struct di_edid_reparse_src *src)
+{
+	struct di_edid *edid;
+	size_t exts_len, used, i;
+	const uint8_t *ext_data;
+
+	if (!validate_edid(data, size))
+		return NULL;
+
+	edid = parse_base_block(arena, data, logger, skip);
+	if (!edid)
+		return NULL;
+
+	exts_len = size / EDID_BLOCK_SIZE - 1;
+	if (lazy && exts_len > 0) {
+		for (i = 0; i < exts_len; i++) {
+			ext_data = (const uint8_t *) data + (i + 1) * EDID_BLOCK_SIZE;
+			if (!_di_edid_validate_block_checksum(ext_data)) {
+				errno = EINVAL;
+				return NULL;
+			}
+		}
+
+		/* The arena is kept until the extensions are decoded */
+		edid->lazy_exts_data = (const uint8_t *) data + EDID_BLOCK_SIZE;
+		edid->lazy_exts_count = exts_len;
+		edid->logger = NULL;
+		return edid;
+	}
+
+	used = _di_arena_get_used(arena);
 	for (i = 0; i < exts_len; i++) {
 		ext_data = (const uint8_t *) data + (i + 1) * EDID_BLOCK_SIZE;
-		if (!parse_ext(edid, ext_data)) {
-			_di_edid_destroy(edid);
+		if (src && reuse_ext(edid, i + 1, ext_data, src))
+			continue;
+		if (!parse_ext(edid, i + 1, ext_data)) {
 			return NULL;
 		}
 	}
 
-	edid->logger = NULL;
+	/* Reused extension blocks have already been added */
+	edid->parse_size += _di_arena_get_used(arena) - used;
+	finish_parse(edid);
 	return edid;
 }
 
-static void
-destroy_display_descriptor(struct di_edid_display_descriptor *desc)
+struct di_edid *
+_di_edid_parse(struct di_arena *arena, const void *data, size_t size,
+	       const struct di_logger *logger, bool lazy,
+	       const struct di_edid_skip *skip)
 {
-	size_t i;
+	return parse_edid(arena, data, size, logger, lazy, skip, NULL);
+}
 
-	switch (desc->tag) {
-	case DI_EDID_DISPLAY_DESCRIPTOR_STD_TIMING_IDS:
-		for (i = 0; i < desc->standard_timings_len; i++) {
-			free(desc->standard_timings[i]);
-		}
-		break;
-	default:
-		break; /* Nothing to do */
-	}
-	free(desc);
+struct di_edid *
+_di_edid_reparse(struct di_arena *arena, const void *data, size_t size,
+		 const struct di_logger *logger,
+		 const struct di_edid_reparse_src *src)
+{
+	return parse_edid(arena, data, size, logger, false, &src->edid->skip,
+			  src);
 }
 
-void
-_di_edid_destroy(struct di_edid *edid)
+struct di_edid *
+_di_edid_parse_base_block(struct di_arena *arena,
+			  const uint8_t data[static_array EDID_BLOCK_SIZE],
+			  const struct di_logger *logger,
+			  const struct di_edid_skip *skip)
 {
-	size_t i;
-	struct di_edid_ext *ext;
+	if (!validate_base_block(data))
+		return NULL;
 
-	for (i = 0; i < edid->standard_timings_len; i++) {
-		free(edid->standard_timings[i]);
-	}
+	return parse_base_block(arena, data, logger, skip);
+}
 
-	for (i = 0; i < edid->detailed_timing_defs_len; i++) {
-		free(edid->detailed_timing_defs[i]);
-	}
+bool
+_di_edid_parse_ext_block(struct di_edid *edid, size_t block_index,
+			 const uint8_t data[static_array EDID_BLOCK_SIZE])
+{
+	size_t used;
 
-	for (i = 0; i < edid->display_descriptors_len; i++) {
-		destroy_display_descriptor(edid->display_descriptors[i]);
-	}
+	assert(block_index > 0);
 
-	for (i = 0; edid->exts[i] != NULL; i++) {
-		ext = edid->exts[i];
-		switch (ext->tag) {
-		case DI_EDID_EXT_CEA:
-			_di_edid_cta_finish(&ext->cta);
-			break;
-		case DI_EDID_EXT_DISPLAYID:
-			_di_displayid_finish(&ext->displayid);
-			break;
-		default:
-			break; /* Nothing to do */
-		}
-		free(ext);
-	}
+	used = _di_arena_get_used(edid->arena);
+	if (!parse_ext(edid, block_index, data))
+		return false;
+	edid->parse_size += _di_arena_get_used(edid->arena) - used;
+	return true;
+}
 
-	free(edid);
+void
+_di_edid_finish_parse(struct di_edid *edid)
+{
+	finish_parse(edid);
 }
 
 int
@@ -1350,7 +1829,14 @@ di_edid_standard_timing_get_dmt(const struct di_edid_standard_timing *t)
 const struct di_edid_standard_timing *const *
 di_edid_get_standard_timings(const struct di_edid *edid)
 {
-	return (const struct di_edid_standard_timing *const *) &edid->standard_timings;
+	return (const struct di_edid_standard_timing *const *) &edid->standard_timing_ptrs;
+}
+
+const struct di_edid_standard_timing *
+di_edid_get_standard_timings_span(const struct di_edid *edid, size_t *len)
+{
+	*len = edid->standard_timings_len;
+	return edid->standard_timings;
 }
 
 const struct di_edid_detailed_timing_def *const *
@@ -1359,12 +1845,26 @@ di_edid_get_detailed_timing_defs(const struct di_edid *edid)
 	return (const struct di_edid_detailed_timing_def *const *) &edid->detailed_timing_defs;
 }
 
+const struct di_edid_detailed_timing_def *const *
+di_edid_get_detailed_timing_defs_span(const struct di_edid *edid, size_t *len)
+{
+	*len = edid->detailed_timing_defs_len;
+	return di_edid_get_detailed_timing_defs(edid);
+}
+
 const struct di_edid_display_descriptor *const *
 di_edid_get_display_descriptors(const struct di_edid *edid)
 {
 	return (const struct di_edid_display_descriptor *const *) &edid->display_descriptors;
 }
 
+const struct di_edid_display_descriptor *const *
+di_edid_get_display_descriptors_span(const struct di_edid *edid, size_t *len)
+{
+	*len = edid->display_descriptors_len;
+	return di_edid_get_display_descriptors(edid);
+}
+
 enum di_edid_display_descriptor_tag
 di_edid_display_descriptor_get_tag(const struct di_edid_display_descriptor *desc)
 {
@@ -1378,7 +1878,7 @@ di_edid_display_descriptor_get_string(const struct di_edid_display_descriptor *d
 	case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_SERIAL:
 	case DI_EDID_DISPLAY_DESCRIPTOR_DATA_STRING:
 	case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_NAME:
-		return desc->str;
+		return ((const struct di_edid_display_descriptor_string *) desc)->str;
 	default:
 		return NULL;
 	}
@@ -1390,7 +1890,7 @@ di_edid_display_descriptor_get_range_limits(const struct di_edid_display_descrip
 	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_RANGE_LIMITS) {
 		return NULL;
 	}
-	return &desc->range_limits.base;
+	return &((const struct di_edid_display_descriptor_range_limits *) desc)->range_limits.base;
 }
 
 const struct di_edid_standard_timing *const *
@@ -1399,7 +1899,23 @@ di_edid_display_descriptor_get_standard_timings(const struct di_edid_display_des
 	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_STD_TIMING_IDS) {
 		return NULL;
 	}
-	return (const struct di_edid_standard_timing *const *) desc->standard_timings;
+	return (const struct di_edid_standard_timing *const *)
+		((const struct di_edid_display_descriptor_standard_timings *) desc)->standard_timing_ptrs;
+}
+
+const struct di_edid_standard_timing *
+di_edid_display_descriptor_get_standard_timings_span(const struct di_edid_display_descriptor *desc,
+						     size_t *len)
+{
+	const struct di_edid_display_descriptor_standard_timings *desc_std;
+
+	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_STD_TIMING_IDS) {
+		*len = 0;
+		return NULL;
+	}
+	desc_std = (const struct di_edid_display_descriptor_standard_timings *) desc;
+	*len = desc_std->standard_timings_len;
+	return desc_std->standard_timings;
 }
 
 const struct di_edid_color_point *const *
@@ -1408,16 +1924,63 @@ di_edid_display_descriptor_get_color_points(const struct di_edid_display_descrip
 	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_COLOR_POINT) {
 		return NULL;
 	}
-	return (const struct di_edid_color_point *const *) desc->color_points;
+	return (const struct di_edid_color_point *const *)
+		((const struct di_edid_display_descriptor_color_points *) desc)->color_point_ptrs;
+}
+
+const struct di_edid_color_point *
+di_edid_display_descriptor_get_color_points_span(const struct di_edid_display_descriptor *desc,
+						 size_t *len)
+{
+	const struct di_edid_display_descriptor_color_points *desc_cp;
+
+	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_COLOR_POINT) {
+		*len = 0;
+		return NULL;
+	}
+	desc_cp = (const struct di_edid_display_descriptor_color_points *) desc;
+	*len = desc_cp->color_points_len;
+	return desc_cp->color_points;
 }
 
 const struct di_dmt_timing *const *
 di_edid_display_descriptor_get_established_timings_iii(const struct di_edid_display_descriptor *desc)
+{
+	struct di_edid_display_descriptor_established_timings_iii *et;
+	size_t i, len;
+	const struct di_dmt_timing *t;
+
+	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_ESTABLISHED_TIMINGS_III) {
+		return NULL;
+	}
+
+	/* The descriptor is allocated from a mutable arena */
+	et = (struct di_edid_display_descriptor_established_timings_iii *) desc;
+	if (_di_once_enter(&et->timings_once)) {
+		len = 0;
+		for (i = 0; i < EDID_MAX_DESCRIPTOR_ESTABLISHED_TIMING_III_COUNT; i++) {
+			if (!(et->mask & ((uint64_t) 1 << i)))
+				continue;
+			t = get_dmt_timing(established_timings_iii[i]);
+			assert(t != NULL);
+			et->timings[len++] = t;
+		}
+		_di_once_leave(&et->timings_once);
+	}
+
+	return et->timings;
+}
+
+const struct di_dmt_timing *const *
+di_edid_display_descriptor_get_established_timings_iii_span(const struct di_edid_display_descriptor *desc,
+							    size_t *len)
 {
 	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_ESTABLISHED_TIMINGS_III) {
+		*len = 0;
 		return NULL;
 	}
-	return desc->established_timings_iii;
+	*len = ((const struct di_edid_display_descriptor_established_timings_iii *) desc)->timings_len;
+	return di_edid_display_descriptor_get_established_timings_iii(desc);
 }
 
 const struct di_edid_color_management_data *
@@ -1426,15 +1989,37 @@ di_edid_display_descriptor_get_color_management_data(const struct di_edid_displa
 	if (desc->tag != DI_EDID_DISPLAY_DESCRIPTOR_DCM_DATA) {
 		return NULL;
 	}
-	return &desc->dcm_data;
+	return &((const struct di_edid_display_descriptor_dcm_data *) desc)->dcm_data;
 }
 
 const struct di_edid_ext *const *
 di_edid_get_extensions(const struct di_edid *edid)
 {
+	struct di_edid *lazy_edid;
+
+	if (edid->lazy_exts_data) {
+		/* The EDID is allocated from a mutable arena */
+		lazy_edid = (struct di_edid *) edid;
+		if (_di_once_enter(&lazy_edid->exts_once)) {
+			decode_lazy_exts(lazy_edid);
+			_di_once_leave(&lazy_edid->exts_once);
+		}
+	}
+
 	return (const struct di_edid_ext *const *) edid->exts;
 }
 
+const struct di_edid_ext *const *
+di_edid_get_extensions_span(const struct di_edid *edid, size_t *len)
+{
+	const struct di_edid_ext *const *exts;
+
+	/* Decodes lazily parsed extensions, which sets exts_len */
+	exts = di_edid_get_extensions(edid);
+	*len = edid->exts_len;
+	return exts;
+}
+
 enum di_edid_ext_tag
 di_edid_ext_get_tag(const struct di_edid_ext *ext)
 {
@@ -1447,7 +2032,7 @@ di_edid_ext_get_cta(const struct di_edid_ext *ext)
 	if (ext->tag != DI_EDID_EXT_CEA) {
 		return NULL;
 	}
-	return &ext->cta;
+	return &((const struct di_edid_ext_cta *) ext)->cta;
 }
 
 const struct di_displayid *
@@ -1456,5 +2041,406 @@ di_edid_ext_get_displayid(const struct di_edid_ext *ext)
 	if (ext->tag != DI_EDID_EXT_DISPLAYID) {
 		return NULL;
 	}
-	return &ext->displayid;
+	return &((const struct di_edid_ext_displayid *) ext)->displayid;
+}
+
+bool
+di_edid_view_init(struct di_edid_view *view, const void *data, size_t size)
+{
+	if (!validate_edid(data, size))
+		return false;
+
+	view->data = data;
+	view->size = size;
+	return true;
+}
+
+int
+di_edid_view_get_version(const struct di_edid_view *view)
+{
+	int version, revision;
+
+	parse_version_revision(view->data, &version, &revision);
+	return version;
+}
+
+int
+di_edid_view_get_revision(const struct di_edid_view *view)
+{
+	int version, revision;
+
+	parse_version_revision(view->data, &version, &revision);
+	return revision;
+}
+
+void
+di_edid_view_get_vendor_product(const struct di_edid_view *view,
+				struct di_edid_vendor_product *vendor_product)
+{
+	*vendor_product = (struct di_edid_vendor_product) {0};
+	decode_vendor_product(di_edid_view_get_revision(view), view->data,
+			      vendor_product);
+}
+
+void
+di_edid_view_get_screen_size(const struct di_edid_view *view,
+			     struct di_edid_screen_size *screen_size)
+{
+	*screen_size = (struct di_edid_screen_size) {0};
+	decode_screen_size(di_edid_view_get_revision(view), view->data,
+			   screen_size);
+}
+
+void
+di_edid_view_get_chromaticity_coords(const struct di_edid_view *view,
+				     struct di_edid_chromaticity_coords *coords)
+{
+	decode_chromaticity_coords(view->data, coords);
+}
+
+bool
+di_edid_view_get_detailed_timing_def(const struct di_edid_view *view,
+				     size_t index,
+				     struct di_edid_view_detailed_timing_def *def)
+{
+	const uint8_t *byte_desc_data;
+	size_t i;
+
+	for (i = 0; i < EDID_BYTE_DESCRIPTOR_COUNT; i++) {
+		byte_desc_data = &view->data[0x36 + i * EDID_BYTE_DESCRIPTOR_SIZE];
+		if (byte_desc_data[0] == 0 && byte_desc_data[1] == 0)
+			continue; /* Display descriptor */
+		if (index-- > 0)
+			continue;
+
+		*def = (struct di_edid_view_detailed_timing_def) {0};
+		decode_detailed_timing_def(byte_desc_data, &def->base,
+					   &def->analog_composite,
+					   &def->bipolar_analog_composite,
+					   &def->digital_composite,
+					   &def->digital_separate);
+		return true;
+	}
+
+	return false;
+}
+
+size_t
+di_edid_view_get_extension_count(const struct di_edid_view *view)
+{
+	return view->size / EDID_BLOCK_SIZE - 1;
+}
+
+enum di_edid_ext_tag
+di_edid_view_get_extension_tag(const struct di_edid_view *view, size_t index)
+{
+	if (index >= di_edid_view_get_extension_count(view))
+		return 0;
+	return view->data[(index + 1) * EDID_BLOCK_SIZE];
+}
+
+bool
+di_edid_probe(const void *data, size_t size, struct di_edid_probe_result *out)
+{
+	struct di_edid_view view;
+	size_t i;
+
+	if (!di_edid_view_init(&view, data, size))
+		return false;
+
+	*out = (struct di_edid_probe_result) {
+		.version = di_edid_view_get_version(&view),
+		.revision = di_edid_view_get_revision(&view),
+		.extensions_len = di_edid_view_get_extension_count(&view),
+	};
+
+	for (i = 0; i < out->extensions_len; i++) {
+		if (!_di_edid_validate_block_checksum(&view.data[(i + 1) * EDID_BLOCK_SIZE])) {
+			errno = EINVAL;
+			return false;
+		}
+		out->extension_tags[i] = di_edid_view_get_extension_tag(&view, i);
+	}
+
+	decode_vendor_product(out->revision, view.data, &out->vendor_product);
+	return true;
+}
+
+/**
+ * Validate an extension block without decoding it, counting its failures.
+ */
+static bool
+check_ext(struct di_edid *edid, size_t block_index,
+	  const uint8_t data[static_array EDID_BLOCK_SIZE], uint32_t flags,
+	  struct di_edid_check_result *counts)
+{
+	struct di_logger logger = {
+		.block_index = block_index,
+	};
+
+	if (!_di_edid_validate_block_checksum(data)) {
+		errno = EINVAL;
+		return false;
+	}
+
+	if (flags & DI_EDID_CHECK_BASE_BLOCK_ONLY)
+		return true;
+
+	switch (data[0x00]) {
+	case DI_EDID_EXT_CEA:
+		logger.section = "CTA-861 Extension Block";
+		logger.failure_count = &counts->cta_failures;
+		return _di_edid_cta_check(data, EDID_BLOCK_SIZE, &logger);
+	case DI_EDID_EXT_VTB:
+	case DI_EDID_EXT_DI:
+	case DI_EDID_EXT_LS:
+	case DI_EDID_EXT_DPVL:
+	case DI_EDID_EXT_BLOCK_MAP:
+	case DI_EDID_EXT_VENDOR:
+		return true; /* Supported */
+	case DI_EDID_EXT_DISPLAYID:
+		logger.section = "DisplayID Extension Block";
+		logger.failure_count = &counts->displayid_failures;
+		return _di_displayid_check(&data[1], EDID_BLOCK_SIZE - 2, &logger);
+	default:
+		/* Unsupported */
+		add_failure_until(edid, 4, DI_FAILURE_EDID_UNKNOWN_EXTENSION);
+		return true;
+	}
+}
+
+bool
+di_edid_check(const void *data, size_t size, uint32_t flags,
+	      struct di_edid_check_result *result)
+{
+	struct di_edid_check_result counts = {0};
+	struct di_edid edid = {0};
+	const uint8_t *ext_data;
+	size_t exts_len, i;
+
+	if (result)
+		*result = counts;
+
+	if (!validate_edid(data, size))
+		return false;
+
+	/* Without an arena, the blob is only validated: the base block is
+	 * decoded into edid, and nothing else is kept */
+	parse_version_revision(data, &edid.version, &edid.revision);
+	edid.base_logger = (struct di_logger) {
+		.block_index = 0,
+		.section = "Base EDID",
+		.failure_count = &counts.base_failures,
+	};
+	edid.logger = &edid.base_logger;
+	if (!decode_base_block(&edid, data))
+		return false;
+
+	exts_len = size / EDID_BLOCK_SIZE - 1;
+	for (i = 0; i < exts_len; i++) {
+		ext_data = (const uint8_t *) data + (i + 1) * EDID_BLOCK_SIZE;
+		if (!check_ext(&edid, i + 1, ext_data, flags, &counts))
+			return false;
+	}
+
+	if (result)
+		*result = counts;
+
+	if (counts.base_failures > 0 || counts.cta_failures > 0 ||
+	    counts.displayid_failures > 0) {
+		errno = EPROTO;
+		return false;
+	}
+	return true;
+}
+
+static void
+hash_area(uint64_t hashes[static_array DI_EDID_AREA_COUNT],
+	  enum di_edid_area area, const uint8_t *data, size_t size)
+{
+	uint8_t len;
+
+	/* Include the size, so that moving bytes between items changes the
+	 * hash */
+	assert(size <= UINT8_MAX);
+	len = (uint8_t) size;
+	hashes[area] = _di_hash_update(hashes[area], &len, sizeof(len));
+	hashes[area] = _di_hash_update(hashes[area], data, size);
+}
+
+static void
+hash_cta_areas(const struct di_edid_view *view, size_t index,
+	       uint64_t hashes[static_array DI_EDID_AREA_COUNT])
+{
+	const uint8_t *data;
+	struct di_edid_view_cta_data_block data_block;
+	size_t offset = 0;
+	uint8_t flags, dtd_start;
+	enum di_edid_area area;
+
+	data = &view->data[(index + 1) * EDID_BLOCK_SIZE];
+
+	/* Basic audio support, and YCbCr 4:4:4 and 4:2:2 support */
+	flags = data[3] & 0x40;
+	hash_area(hashes, DI_EDID_AREA_AUDIO, &flags, sizeof(flags));
+	flags = data[3] & 0x30;
+	hash_area(hashes, DI_EDID_AREA_COLORIMETRY, &flags, sizeof(flags));
+
+	while (di_edid_view_next_cta_data_block(view, index, &offset,
+						&data_block)) {
+		switch (data_block.tag_code) {
+		case 1: /* Audio */
+		case 4: /* Speaker Allocation */
+			area = DI_EDID_AREA_AUDIO;
+			break;
+		case 2: /* Video */
+		case 3: /* Vendor-Specific, such as HDMI capabilities */
+			area = DI_EDID_AREA_MODES;
+			break;
+		case 5: /* VESA Display Transfer Characteristic */
+			area = DI_EDID_AREA_COLORIMETRY;
+			break;
+		case 7:
+			switch (data_block.extended_tag_code) {
+			case 0: /* Video Capability */
+			case 5: /* Colorimetry */
+				area = DI_EDID_AREA_COLORIMETRY;
+				break;
+			case 1: /* Vendor-Specific Video */
+			case 6: /* HDR Static Metadata */
+			case 7: /* HDR Dynamic Metadata */
+				area = DI_EDID_AREA_HDR;
+				break;
+			case 13: /* Video Format Preference */
+			case 14: /* YCbCr 4:2:0 Video */
+			case 15: /* YCbCr 4:2:0 Capability Map */
+			case 34: /* DisplayID Type VII Video Timing */
+			case 35: /* DisplayID Type VIII Video Timing */
+			case 42: /* DisplayID Type X Video Timing */
+			case 121: /* HDMI Forum Sink Capability */
+				area = DI_EDID_AREA_MODES;
+				break;
+			case 17: /* Vendor-Specific Audio */
+			case 18: /* Room Configuration */
+			case 19: /* Speaker Location */
+				area = DI_EDID_AREA_AUDIO;
+				break;
+			default:
+				continue;
+			}
+			/* The same payload may have another meaning */
+			hash_area(hashes, area, &data_block.extended_tag_code, 1);
+			break;
+		default:
+			continue;
+		}
+
+		hash_area(hashes, area, &data_block.tag_code, 1);
+		hash_area(hashes, area, data_block.data, data_block.size);
+	}
+
+	/* Detailed timing descriptors fill the rest of the block */
+	dtd_start = data[2];
+	if (dtd_start >= 4 && dtd_start < EDID_BLOCK_SIZE - 1)
+		hash_area(hashes, DI_EDID_AREA_MODES, &data[dtd_start],
+			  (size_t) (EDID_BLOCK_SIZE - 1 - dtd_start));
+}
+
+void
+_di_edid_hash_areas(const uint8_t *data, size_t size,
+		    uint64_t hashes[static_array DI_EDID_AREA_COUNT])
+{
+	struct di_edid_view view;
+	const uint8_t *desc;
+	size_t i;
+	enum di_edid_area area;
+
+	for (i = 0; i < DI_EDID_AREA_COUNT; i++)
+		hashes[i] = DI_HASH_INIT;
+
+	if (!di_edid_view_init(&view, data, size))
+		return;
+
+	/* Vendor & product identification */
+	hash_area(hashes, DI_EDID_AREA_IDENTITY, &data[0x08], 0x12 - 0x08);
+	/* Established and standard timings */
+	hash_area(hashes, DI_EDID_AREA_MODES, &data[0x23], 0x36 - 0x23);
+	/* Video input definition, gamma, features and chromaticity */
+	hash_area(hashes, DI_EDID_AREA_COLORIMETRY, &data[0x14], 1);
+	hash_area(hashes, DI_EDID_AREA_COLORIMETRY, &data[0x17], 0x23 - 0x17);
+
+	for (i = 0; i < EDID_BYTE_DESCRIPTOR_COUNT; i++) {
+		desc = &data[0x36 + i * EDID_BYTE_DESCRIPTOR_SIZE];
+		if (desc[0] || desc[1]) {
+			if (i == 0)
+				hash_area(hashes, DI_EDID_AREA_PREFERRED_TIMING,
+					  desc, EDID_BYTE_DESCRIPTOR_SIZE);
+			hash_area(hashes, DI_EDID_AREA_MODES, desc,
+				  EDID_BYTE_DESCRIPTOR_SIZE);
+			continue;
+		}
+
+		switch (desc[3]) {
+		case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_SERIAL:
+		case DI_EDID_DISPLAY_DESCRIPTOR_DATA_STRING:
+		case DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_NAME:
+			area = DI_EDID_AREA_IDENTITY;
+			break;
+		case DI_EDID_DISPLAY_DESCRIPTOR_RANGE_LIMITS:
+			area = DI_EDID_AREA_RANGE_LIMITS;
+			break;
+		case DI_EDID_DISPLAY_DESCRIPTOR_COLOR_POINT:
+		case DI_EDID_DISPLAY_DESCRIPTOR_DCM_DATA:
+			area = DI_EDID_AREA_COLORIMETRY;
+			break;
+		case DI_EDID_DISPLAY_DESCRIPTOR_STD_TIMING_IDS:
+		case DI_EDID_DISPLAY_DESCRIPTOR_CVT_TIMING_CODES:
+		case DI_EDID_DISPLAY_DESCRIPTOR_ESTABLISHED_TIMINGS_III:
+			area = DI_EDID_AREA_MODES;
+			break;
+		default:
+			continue;
+		}
+		hash_area(hashes, area, desc, EDID_BYTE_DESCRIPTOR_SIZE);
+	}
+
+	for (i = 0; i < di_edid_view_get_extension_count(&view); i++) {
+		switch (di_edid_view_get_extension_tag(&view, i)) {
+		case DI_EDID_EXT_CEA:
+			hash_cta_areas(&view, i, hashes);
+			break;
+		case DI_EDID_EXT_DISPLAYID:
+			/* Mostly made of timings */
+			hash_area(hashes, DI_EDID_AREA_MODES,
+				  &data[(i + 1) * EDID_BLOCK_SIZE],
+				  EDID_BLOCK_SIZE);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+uint64_t
+_di_edid_hash_identity(const uint8_t *data, size_t size)
+{
+	uint64_t hash = DI_HASH_INIT;
+	const uint8_t *desc;
+	size_t i;
+
+	if (size < EDID_BLOCK_SIZE)
+		return hash;
+
+	/* Manufacturer, product code, serial number and manufacture date */
+	hash = _di_hash_update(hash, &data[0x08], 0x12 - 0x08);
+
+	for (i = 0; i < EDID_BYTE_DESCRIPTOR_COUNT; i++) {
+		desc = &data[0x36 + i * EDID_BYTE_DESCRIPTOR_SIZE];
+		if (desc[0] == 0 && desc[1] == 0 &&
+		    desc[3] == DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_SERIAL)
+			hash = _di_hash_update(hash, &desc[5],
+					       EDID_BYTE_DESCRIPTOR_SIZE - 5);
+	}
+
+	return hash;
 }
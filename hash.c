@@ -0,0 +1,17 @@
+#include "hash.h"
+
+#define FNV_PRIME UINT64_C(0x100000001b3)
+
+uint64_t
+_di_hash_update(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
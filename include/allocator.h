@@ -0,0 +1,33 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+/**
+ * Private memory allocation utilities.
+ *
+ * All of the library's heap allocations go through these functions. A NULL
+ * allocator selects the C library.
+ */
+
+#include <stddef.h>
+
+#include <libdisplay-info/info.h>
+
+void *
+_di_malloc(const struct di_allocator *allocator, size_t size);
+
+void *
+_di_calloc(const struct di_allocator *allocator, size_t nmemb, size_t size);
+
+void
+_di_free(const struct di_allocator *allocator, void *ptr);
+
+/**
+ * Resize an allocation, preserving its first old_size bytes.
+ *
+ * On failure, NULL is returned and ptr is left untouched.
+ */
+void *
+_di_realloc(const struct di_allocator *allocator, void *ptr,
+	    size_t old_size, size_t new_size);
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/**
+ * Private bump allocator.
+ *
+ * An arena hands out zero-initialized memory from large chunks. Individual
+ * allocations cannot be released: all memory is released at once when the
+ * arena is finished.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct di_allocator;
+struct di_arena_chunk;
+
+struct di_arena {
+	/* Most recently allocated chunk first */
+	struct di_arena_chunk *chunks;
+	/* Minimum size of the next chunk */
+	size_t chunk_size;
+	/* Backed by a caller-provided buffer, never grows */
+	bool fixed;
+	/* Used to allocate chunks, NULL for the C library */
+	const struct di_allocator *allocator;
+};
+
+/**
+ * Initialize an arena.
+ *
+ * No memory is allocated until the first call to _di_arena_alloc(). The first
+ * chunk will be able to hold at least chunk_size bytes. Chunks are allocated
+ * with the provided allocator, which may be NULL.
+ */
+void
+_di_arena_init(struct di_arena *arena, size_t chunk_size,
+	       const struct di_allocator *allocator);
+
+/**
+ * Initialize an arena backed by a caller-provided buffer.
+ *
+ * The arena never allocates memory: once the buffer is exhausted,
+ * _di_arena_alloc() fails. Returns false if the buffer is too small to be
+ * used at all.
+ */
+bool
+_di_arena_init_buffer(struct di_arena *arena, void *buf, size_t size);
+
+/**
+ * Set the minimum size of the next chunk.
+ *
+ * Chunk sizes grow geometrically by default: this can be used to size the next
+ * chunk exactly when the remaining allocations are known.
+ */
+void
+_di_arena_set_chunk_size(struct di_arena *arena, size_t chunk_size);
+
+/**
+ * Get the number of bytes consumed by a _di_arena_alloc() call.
+ */
+size_t
+_di_arena_get_alloc_size(size_t size);
+
+/**
+ * Get the buffer size needed for _di_arena_init_buffer() so that
+ * allocations consuming a total of alloc_size bytes succeed.
+ */
+size_t
+_di_arena_get_buffer_size(size_t alloc_size);
+
+/**
+ * Allocate zero-initialized memory suitably aligned for any type.
+ *
+ * Returns NULL and sets errno on allocation failure.
+ */
+void *
+_di_arena_alloc(struct di_arena *arena, size_t size);
+
+/**
+ * Get the number of bytes consumed by allocations so far.
+ */
+size_t
+_di_arena_get_used(const struct di_arena *arena);
+
+/**
+ * Get the number of bytes held by the arena, including chunk headers and
+ * unused space.
+ */
+size_t
+_di_arena_get_reserved(const struct di_arena *arena);
+
+/**
+ * Release all allocations, keeping the memory around for reuse.
+ *
+ * If the arena has grown to more than one chunk, the chunks are coalesced so
+ * that the next allocations of the same total size only need a single chunk.
+ */
+void
+_di_arena_reset(struct di_arena *arena);
+
+/**
+ * Release all memory owned by an arena.
+ *
+ * The arena struct itself may live in memory allocated from the arena.
+ */
+void
+_di_arena_finish(struct di_arena *arena);
+
+#endif
@@ -11,13 +11,8 @@
 
 #include <libdisplay-info/cta.h>
 
-/**
- * The maximum number of data blocks in an EDID CTA block.
- *
- * Each data block takes at least 1 byte, the CTA block can hold 128 bytes, and
- * the mandatory fields take up 5 bytes (4 header bytes + checksum).
- */
-#define EDID_CTA_MAX_DATA_BLOCKS 123
+#include "arena.h"
+
 /**
  * The maximum number of detailed timing definitions included in an EDID CTA
  * block.
@@ -38,8 +33,8 @@ struct di_edid_cta {
 	int revision;
 	struct di_edid_cta_flags flags;
 
-	/* NULL-terminated */
-	struct di_cta_data_block *data_blocks[EDID_CTA_MAX_DATA_BLOCKS + 1];
+	/* NULL-terminated, sized for the data block headers in the block */
+	struct di_cta_data_block **data_blocks;
 	size_t data_blocks_len;
 
 	/* NULL-terminated */
@@ -47,6 +42,9 @@ struct di_edid_cta {
 	size_t detailed_timing_defs_len;
 
 	struct di_logger *logger;
+	struct di_arena *arena;
+	/* Bitmask of data block tags left out of data_blocks */
+	uint64_t skip_data_blocks;
 };
 
 struct di_cta_hdr_static_metadata_block_priv {
@@ -56,9 +54,11 @@ struct di_cta_hdr_static_metadata_block_priv {
 };
 
 struct di_cta_video_block {
-	/* NULL-terminated */
-	struct di_cta_svd *svds[EDID_CTA_MAX_VIDEO_BLOCK_ENTRIES + 1];
+	/* Contiguous array of svds_len entries */
+	struct di_cta_svd *svds;
 	size_t svds_len;
+	/* NULL-terminated, points into svds */
+	struct di_cta_svd **svd_ptrs;
 };
 
 struct di_cta_data_block {
@@ -76,11 +76,34 @@ struct di_cta_data_block {
 	struct di_cta_vesa_transfer_characteristics vesa_transfer_characteristics;
 };
 
+/**
+ * Parse a CTA-861 extension block.
+ *
+ * All of the data structures are allocated from the provided arena. Data
+ * blocks whose tag bit is set in skip_data_blocks are only bounds-checked.
+ *
+ * If the arena is NULL, the block is only validated: failures are reported,
+ * but nothing is allocated and cta only holds the header fields.
+ */
 bool
 _di_edid_cta_parse(struct di_edid_cta *cta, const uint8_t *data, size_t size,
-		   struct di_logger *logger);
+		   struct di_arena *arena, struct di_logger *logger,
+		   uint64_t skip_data_blocks);
+
+/**
+ * Validate a CTA-861 extension block without decoding it, reporting the same
+ * failures as _di_edid_cta_parse().
+ */
+bool
+_di_edid_cta_check(const uint8_t *data, size_t size, struct di_logger *logger);
 
-void
-_di_edid_cta_finish(struct di_edid_cta *cta);
+/**
+ * Get the arena memory consumed by _di_edid_cta_parse().
+ *
+ * The result is exact if parsing succeeds without skipping data blocks, and an
+ * upper bound otherwise.
+ */
+size_t
+_di_edid_cta_get_parse_size(const uint8_t *data, size_t size);
 
 #endif
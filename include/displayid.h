@@ -11,15 +11,9 @@
 
 #include <libdisplay-info/displayid.h>
 
+#include "arena.h"
 #include "log.h"
 
-/**
- * The maximum number of data blocks in a DisplayID section.
- *
- * A DisplayID section has a payload size of 251 bytes, and each data block has
- * a minimum size of 3 bytes.
- */
-#define DISPLAYID_MAX_DATA_BLOCKS 83
 /**
  * The maximum number of type I timings in a data block.
  *
@@ -32,10 +26,14 @@ struct di_displayid {
 	int version, revision;
 	enum di_displayid_product_type product_type;
 
-	struct di_displayid_data_block *data_blocks[DISPLAYID_MAX_DATA_BLOCKS + 1];
+	/* NULL-terminated, sized for the data block headers in the section */
+	struct di_displayid_data_block **data_blocks;
 	size_t data_blocks_len;
 
 	struct di_logger *logger;
+	struct di_arena *arena;
+	/* Bitmask of data block tags left out of data_blocks */
+	uint64_t skip_data_blocks;
 };
 
 struct di_displayid_display_params_priv {
@@ -46,19 +44,46 @@ struct di_displayid_display_params_priv {
 struct di_displayid_data_block {
 	enum di_displayid_data_block_tag tag;
 
-	/* Used for TYPE_I_TIMING, NULL-terminated */
-	struct di_displayid_type_i_timing *type_i_timings[DISPLAYID_MAX_TYPE_I_TIMINGS + 1];
+	/* Used for TYPE_I_TIMING, contiguous array of type_i_timings_len
+	 * entries */
+	struct di_displayid_type_i_timing *type_i_timings;
 	size_t type_i_timings_len;
+	/* Used for TYPE_I_TIMING, NULL-terminated, points into
+	 * type_i_timings */
+	struct di_displayid_type_i_timing **type_i_timing_ptrs;
 
 	/* Used for DISPLAY_PARAMS */
 	struct di_displayid_display_params_priv display_params;
 };
 
+/**
+ * Parse a DisplayID section.
+ *
+ * All of the data structures are allocated from the provided arena. Data
+ * blocks whose tag bit is set in skip_data_blocks are only bounds-checked.
+ *
+ * If the arena is NULL, the section is only validated: failures are reported,
+ * but nothing is allocated and displayid only holds the header fields.
+ */
 bool
 _di_displayid_parse(struct di_displayid *displayid, const uint8_t *data,
-		    size_t size, struct di_logger *logger);
+		    size_t size, struct di_arena *arena,
+		    struct di_logger *logger, uint64_t skip_data_blocks);
 
-void
-_di_displayid_finish(struct di_displayid *displayid);
+/**
+ * Validate a DisplayID section without decoding it, reporting the same
+ * failures as _di_displayid_parse().
+ */
+bool
+_di_displayid_check(const uint8_t *data, size_t size, struct di_logger *logger);
+
+/**
+ * Get the arena memory consumed by _di_displayid_parse().
+ *
+ * The result is exact if parsing succeeds without skipping data blocks, and an
+ * upper bound otherwise.
+ */
+size_t
+_di_displayid_get_parse_size(const uint8_t *data, size_t size);
 
 #endif
@@ -7,13 +7,19 @@
 
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
 
 #include <libdisplay-info/edid.h>
 
+#include "arena.h"
 #include "cta.h"
 #include "displayid.h"
+#include "log.h"
+#include "once.h"
 
+/**
+ * The size of an EDID block, defined in section 2.2.
+ */
+#define EDID_BLOCK_SIZE 128
 /**
  * The maximum number of EDID blocks (including the base block), defined in
  * section 2.2.1.
@@ -55,6 +61,27 @@ struct di_edid_detailed_timing_def_priv {
 	struct di_edid_detailed_timing_digital_separate digital_separate;
 };
 
+/**
+ * A range of the failure message buffer, without the separator from the
+ * previous section, or a range of the failure records.
+ */
+struct di_edid_failure_msg_range {
+	size_t start, len;
+	/* Range of the failure codes */
+	size_t failures_start, failures_len;
+};
+
+/**
+ * Parts of an EDID blob which are only validated, not decoded.
+ */
+struct di_edid_skip {
+	/* Detailed timing definitions and display descriptors of the base
+	 * block */
+	bool base_descriptors;
+	/* Bitmasks of CTA-861 and DisplayID data block tags */
+	uint64_t cta_data_blocks, displayid_data_blocks;
+};
+
 struct di_edid {
 	struct di_edid_vendor_product vendor_product;
 	int version, revision;
@@ -72,9 +99,10 @@ struct di_edid {
 	struct di_edid_chromaticity_coords chromaticity_coords;
 	struct di_edid_established_timings_i_ii established_timings_i_ii;
 
-	/* NULL-terminated */
-	struct di_edid_standard_timing *standard_timings[EDID_MAX_STANDARD_TIMING_COUNT + 1];
+	struct di_edid_standard_timing standard_timings[EDID_MAX_STANDARD_TIMING_COUNT];
 	size_t standard_timings_len;
+	/* NULL-terminated, points into standard_timings */
+	struct di_edid_standard_timing *standard_timing_ptrs[EDID_MAX_STANDARD_TIMING_COUNT + 1];
 
 	/* NULL-terminated */
 	struct di_edid_detailed_timing_def_priv *detailed_timing_defs[EDID_BYTE_DESCRIPTOR_COUNT + 1];
@@ -84,11 +112,35 @@ struct di_edid {
 	struct di_edid_display_descriptor *display_descriptors[EDID_BYTE_DESCRIPTOR_COUNT + 1];
 	size_t display_descriptors_len;
 
-	/* NULL-terminated, doesn't include the base block */
-	struct di_edid_ext *exts[EDID_MAX_BLOCK_COUNT];
+	/* NULL-terminated, doesn't include the base block, sized for the
+	 * extension count of the base block */
+	struct di_edid_ext **exts;
 	size_t exts_len;
+	/* Failure messages of each entry of exts, in the failure message
+	 * buffer or in the failure records */
+	struct di_edid_failure_msg_range *ext_failure_msgs;
+
+	/* Parts of the blob which were not decoded */
+	struct di_edid_skip skip;
+
+	/* Arena bytes used by the whole parsed EDID, and by its CTA and
+	 * DisplayID extensions */
+	size_t parse_size, cta_parse_size, displayid_parse_size;
+
+	/* Lazy parsing: copy of the extension blocks, decoded on first access
+	 * to the extensions. NULL if there is nothing to decode. */
+	const uint8_t *lazy_exts_data;
+	size_t lazy_exts_count;
+	struct di_once exts_once;
+
+	/* Base block logger, also used to decode the extension blocks after
+	 * the base block has been parsed */
+	struct di_logger base_logger;
 
 	struct di_logger *logger;
+	/* Kept until the extensions are decoded when parsing lazily, NULL
+	 * when di_edid_check() only validates the base block */
+	struct di_arena *arena;
 };
 
 struct di_edid_display_range_limits_priv {
@@ -97,54 +149,235 @@ struct di_edid_display_range_limits_priv {
 	struct di_edid_display_range_limits_cvt cvt;
 };
 
+/**
+ * An EDID display descriptor.
+ *
+ * Only the struct matching the tag is allocated: one of the
+ * struct di_edid_display_descriptor_* below, or a bare
+ * struct di_edid_display_descriptor for tags without a payload.
+ */
 struct di_edid_display_descriptor {
 	enum di_edid_display_descriptor_tag tag;
-	/* Used for PRODUCT_SERIAL, DATA_STRING and PRODUCT_NAME,
-	 * zero-terminated */
+};
+
+/* Used for PRODUCT_SERIAL, DATA_STRING and PRODUCT_NAME */
+struct di_edid_display_descriptor_string {
+	struct di_edid_display_descriptor base;
+	/* Zero-terminated */
 	char str[14];
-	/* Used for RANGE_LIMITS */
+};
+
+/* Used for RANGE_LIMITS */
+struct di_edid_display_descriptor_range_limits {
+	struct di_edid_display_descriptor base;
 	struct di_edid_display_range_limits_priv range_limits;
-	/* Used for STD_TIMING_IDS, NULL-terminated */
-	struct di_edid_standard_timing *standard_timings[EDID_MAX_DESCRIPTOR_STANDARD_TIMING_COUNT + 1];
+};
+
+/* Used for STD_TIMING_IDS */
+struct di_edid_display_descriptor_standard_timings {
+	struct di_edid_display_descriptor base;
+	struct di_edid_standard_timing standard_timings[EDID_MAX_DESCRIPTOR_STANDARD_TIMING_COUNT];
 	size_t standard_timings_len;
-	/* Used for COLOR_POINT, NULL-terminated */
-	struct di_edid_color_point *color_points[EDID_MAX_DESCRIPTOR_COLOR_POINT_COUNT + 1];
+	/* NULL-terminated, points into standard_timings */
+	struct di_edid_standard_timing *standard_timing_ptrs[EDID_MAX_DESCRIPTOR_STANDARD_TIMING_COUNT + 1];
+};
+
+/* Used for COLOR_POINT */
+struct di_edid_display_descriptor_color_points {
+	struct di_edid_display_descriptor base;
+	struct di_edid_color_point color_points[EDID_MAX_DESCRIPTOR_COLOR_POINT_COUNT];
 	size_t color_points_len;
-	/* Used for ESTABLISHED_TIMINGS_III, NULL-terminated */
-	const struct di_dmt_timing *established_timings_iii[EDID_MAX_DESCRIPTOR_ESTABLISHED_TIMING_III_COUNT + 1];
-	size_t established_timings_iii_len;
-	/* Used for DCM_DATA */
+	/* NULL-terminated, points into color_points */
+	struct di_edid_color_point *color_point_ptrs[EDID_MAX_DESCRIPTOR_COLOR_POINT_COUNT + 1];
+};
+
+/* Used for ESTABLISHED_TIMINGS_III */
+struct di_edid_display_descriptor_established_timings_iii {
+	struct di_edid_display_descriptor base;
+	/* One bit per entry of the established timings III table, the most
+	 * significant bit of byte 6 first */
+	uint64_t mask;
+	/* NULL-terminated, one slot per bit set in mask, resolved on first
+	 * access */
+	const struct di_dmt_timing **timings;
+	size_t timings_len;
+	struct di_once timings_once;
+};
+
+/* Used for DCM_DATA */
+struct di_edid_display_descriptor_dcm_data {
+	struct di_edid_display_descriptor base;
 	struct di_edid_color_management_data dcm_data;
 };
 
+/**
+ * An EDID extension block.
+ *
+ * Only the struct matching the tag is allocated: a struct di_edid_ext_cta for
+ * DI_EDID_EXT_CEA, a struct di_edid_ext_displayid for DI_EDID_EXT_DISPLAYID
+ * and a bare struct di_edid_ext for other tags.
+ */
 struct di_edid_ext {
 	enum di_edid_ext_tag tag;
-	/* Used for DI_EDID_EXT_CEA */
+	/* Index of the block in the blob, starting at 1 */
+	size_t block_index;
+	/* Arena bytes used by this extension block */
+	size_t parse_size;
+};
+
+struct di_edid_ext_cta {
+	struct di_edid_ext base;
 	struct di_edid_cta cta;
-	/* Used for DI_EDID_EXT_DISPLAYID */
+};
+
+struct di_edid_ext_displayid {
+	struct di_edid_ext base;
 	struct di_displayid displayid;
 };
 
 /**
  * Create an EDID data structure.
  *
- * Callers do not need to keep the provided data pointer valid after calling
- * this function. Callers should destroy the returned pointer via
- * di_edid_destroy().
+ * Unless parsing lazily, callers do not need to keep the provided data pointer
+ * valid after calling this function. All of the returned data structure is allocated from the
+ * provided arena, and is released when the arena is finished.
+ *
+ * Failure messages are written to the destination of logger, which may be
+ * NULL: only its f, buf, records and failures fields are used.
+ *
+ * If lazy is set, only the checksums of the extension blocks are validated:
+ * the blocks are decoded on the first di_edid_get_extensions() call. The data,
+ * the arena and the failure message destination must then stay valid until
+ * the EDID is released. Extension blocks which fail to decode are reported as
+ * failure messages instead.
+ *
+ * The parts set in skip are not decoded, skip may be NULL.
  */
 struct di_edid *
-_di_edid_parse(const void *data, size_t size, FILE *failure_msg_file);
+_di_edid_parse(struct di_arena *arena, const void *data, size_t size,
+	       const struct di_logger *logger, bool lazy,
+	       const struct di_edid_skip *skip);
 
 /**
- * Destroy an EDID data structure.
+ * Create an EDID data structure from its base block only.
+ *
+ * The header, the version and the checksum of the base block are checked.
+ * The extension blocks are then decoded one at a time with
+ * _di_edid_parse_ext_block(), in order, and _di_edid_finish_parse() must be
+ * called after the last one. Failure messages are written to the destination
+ * of logger, which must stay valid until then. The parts set in skip are not decoded,
+ * skip may be NULL.
+ */
+struct di_edid *
+_di_edid_parse_base_block(struct di_arena *arena,
+			  const uint8_t data[static_array EDID_BLOCK_SIZE],
+			  const struct di_logger *logger,
+			  const struct di_edid_skip *skip);
+
+/**
+ * Decode an extension block of an EDID created by _di_edid_parse_base_block().
+ *
+ * block_index starts at 1 for the first extension block.
+ */
+bool
+_di_edid_parse_ext_block(struct di_edid *edid, size_t block_index,
+			 const uint8_t data[static_array EDID_BLOCK_SIZE]);
+
+/**
+ * Complete a parse started with _di_edid_parse_base_block().
+ */
+void
+_di_edid_finish_parse(struct di_edid *edid);
+
+/**
+ * A previous parse whose extension blocks can be reused by
+ * _di_edid_reparse().
+ */
+struct di_edid_reparse_src {
+	const struct di_edid *edid;
+	/* The blob the EDID was parsed from */
+	const uint8_t *data;
+	size_t size;
+	/* Failure messages written by the previous parse, may be NULL */
+	const char *failure_msg;
+	size_t failure_msg_len;
+	/* Failures recorded by the previous parse, may be NULL */
+	const struct di_log_records *failure_records;
+	/* Failure codes of the previous parse, may be NULL */
+	const struct di_failure_list *failures;
+};
+
+/**
+ * Create an EDID data structure, reusing extension blocks of a previous parse.
+ *
+ * This behaves like _di_edid_parse(). Extension blocks identical to the block
+ * at the same index in the previous blob are not decoded again: the previous
+ * struct di_edid_ext is shared, and its failure messages are copied. The
+ * previous EDID must have been allocated from the same arena, and is left
+ * untouched. The parts skipped by the previous parse are skipped again.
+ */
+struct di_edid *
+_di_edid_reparse(struct di_arena *arena, const void *data, size_t size,
+		 const struct di_logger *logger,
+		 const struct di_edid_reparse_src *src);
+
+/**
+ * Get the arena memory consumed by _di_edid_parse(), by scanning the blob
+ * without decoding it.
+ *
+ * The result is exact if parsing succeeds without skipping anything, and an
+ * upper bound otherwise.
+ *
+ * Returns zero and sets errno if the EDID blob is invalid.
+ */
+size_t
+_di_edid_get_parse_size(const void *data, size_t size);
+
+/**
+ * Areas of an EDID blob hashed by _di_edid_hash_areas(), in the same order as
+ * enum di_info_diff_area.
+ */
+enum di_edid_area {
+	DI_EDID_AREA_IDENTITY,
+	DI_EDID_AREA_PREFERRED_TIMING,
+	DI_EDID_AREA_MODES,
+	DI_EDID_AREA_HDR,
+	DI_EDID_AREA_COLORIMETRY,
+	DI_EDID_AREA_RANGE_LIMITS,
+	DI_EDID_AREA_AUDIO,
+
+	DI_EDID_AREA_COUNT
+};
+
+/**
+ * Hash the bytes encoding each area of an EDID blob, without decoding it.
+ *
+ * The blob must have been validated by _di_edid_parse().
  */
 void
-_di_edid_destroy(struct di_edid *edid);
+_di_edid_hash_areas(const uint8_t *data, size_t size,
+		    uint64_t hashes[static_array DI_EDID_AREA_COUNT]);
+
+/**
+ * Hash the identification of an EDID blob: the vendor & product
+ * identification, and the product serial number descriptor.
+ *
+ * The blob must have been validated by _di_edid_parse().
+ */
+uint64_t
+_di_edid_hash_identity(const uint8_t *data, size_t size);
+
+/**
+ * Check whether the bytes of an EDID block sum to zero.
+ */
+bool
+_di_edid_validate_block_checksum(const uint8_t data[static_array EDID_BLOCK_SIZE]);
 
 /**
  * Parse an EDID detailed timing definition.
  */
 struct di_edid_detailed_timing_def_priv *
-_di_edid_parse_detailed_timing_def(const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE]);
+_di_edid_parse_detailed_timing_def(struct di_arena *arena,
+				   const uint8_t data[static_array EDID_BYTE_DESCRIPTOR_SIZE]);
 
 #endif
@@ -0,0 +1,105 @@
+#ifndef FAILURE_H
+#define FAILURE_H
+
+/**
+ * Private failure classification utilities.
+ */
+
+#include <libdisplay-info/info.h>
+
+/**
+ * Failures less severe than this enum di_failure_severity value are compiled
+ * out of the library, set by the min_failure_severity build option.
+ */
+#ifndef DI_MIN_FAILURE_SEVERITY
+#define DI_MIN_FAILURE_SEVERITY 0
+#endif
+
+/**
+ * Whether failures of the specified code are built in. The code must be an
+ * enum di_failure_code constant: this is a constant expression, so that the
+ * code logging the failures compiles away otherwise.
+ */
+#define DI_FAILURE_ENABLED(code) ((int) code##_SEVERITY >= DI_MIN_FAILURE_SEVERITY)
+
+/*
+ * Severity of each enum di_failure_code value. X is invoked with the code and
+ * the severity suffix: PEDANTIC, WARNING or ERROR.
+ */
+#define DI_FAILURE_SEVERITIES(X) \
+	X(DI_FAILURE_EDID_RESERVED_YEAR, WARNING) \
+	X(DI_FAILURE_EDID_INVALID_WEEK, WARNING) \
+	X(DI_FAILURE_EDID_RESERVED_VIDEO_INTERFACE, WARNING) \
+	X(DI_FAILURE_EDID_RESERVED_COLOR_BIT_DEPTH, WARNING) \
+	X(DI_FAILURE_EDID_PARTIAL_PRIMARIES, WARNING) \
+	X(DI_FAILURE_EDID_UNSET_WHITE_POINT, WARNING) \
+	X(DI_FAILURE_EDID_INVALID_STANDARD_TIMING_CODE, PEDANTIC) \
+	X(DI_FAILURE_EDID_RESERVED_RANGE_OFFSET_FLAGS, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_RESERVED_OFFSET_BITS, PEDANTIC) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_OFFSET, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_RESERVED, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_VERT_RATE_ORDER, ERROR) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_HORIZ_FREQ_ORDER, ERROR) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_NO_MAX_DOTCLOCK, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_BARE_LIMITS, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_CVT, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_UNKNOWN_CLASS, ERROR) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_GTF_NON_CONTINUOUS, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_CVT_NON_CONTINUOUS, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_INVALID_BYTE_11, PEDANTIC) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_CVT_RESERVED_BITS, PEDANTIC) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_CVT_INVALID_ASPECT_RATIO, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_CVT_NO_PREFERRED_REFRESH, WARNING) \
+	X(DI_FAILURE_EDID_RANGE_LIMITS_INVALID_PADDING, PEDANTIC) \
+	X(DI_FAILURE_EDID_STANDARD_TIMINGS_NO_LINE_FEED, PEDANTIC) \
+	X(DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_UNSUPPORTED, WARNING) \
+	X(DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_RESERVED_BITS, PEDANTIC) \
+	X(DI_FAILURE_EDID_RESERVED_WHITE_POINT_INDEX, WARNING) \
+	X(DI_FAILURE_EDID_INVALID_COLOR_MANAGEMENT_VERSION, WARNING) \
+	X(DI_FAILURE_EDID_INVALID_DESCRIPTOR_ORDERING, ERROR) \
+	X(DI_FAILURE_EDID_NO_PREFERRED_TIMING, ERROR) \
+	X(DI_FAILURE_EDID_UNKNOWN_DISPLAY_DESCRIPTOR, WARNING) \
+	X(DI_FAILURE_EDID_UNKNOWN_EXTENSION, WARNING) \
+	X(DI_FAILURE_EDID_EXTENSION_DECODE_FAILED, ERROR) \
+	X(DI_FAILURE_CTA_VIDEO_EMPTY, WARNING) \
+	X(DI_FAILURE_CTA_VIDEO_UNKNOWN_VIC, WARNING) \
+	X(DI_FAILURE_CTA_VIDEO_CAP_EMPTY, ERROR) \
+	X(DI_FAILURE_CTA_VIDEO_CAP_NO_SELECTABLE_RGB_QUANT, PEDANTIC) \
+	X(DI_FAILURE_CTA_VIDEO_CAP_IT_SCAN_MISMATCH, WARNING) \
+	X(DI_FAILURE_CTA_COLORIMETRY_EMPTY, ERROR) \
+	X(DI_FAILURE_CTA_COLORIMETRY_RESERVED_BITS, PEDANTIC) \
+	X(DI_FAILURE_CTA_HDR_STATIC_METADATA_EMPTY, ERROR) \
+	X(DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_EOTF, WARNING) \
+	X(DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_DESCRIPTOR, WARNING) \
+	X(DI_FAILURE_CTA_HDR_STATIC_METADATA_MIN_WITHOUT_MAX, WARNING) \
+	X(DI_FAILURE_CTA_INVALID_DATA_BLOCK_LENGTH, ERROR) \
+	X(DI_FAILURE_CTA_EMPTY_EXTENDED_DATA_BLOCK, ERROR) \
+	X(DI_FAILURE_CTA_UNKNOWN_EXTENDED_DATA_BLOCK, WARNING) \
+	X(DI_FAILURE_CTA_UNKNOWN_DATA_BLOCK, WARNING) \
+	X(DI_FAILURE_CTA_NON_ZERO_BYTE_3, PEDANTIC) \
+	X(DI_FAILURE_CTA_INVALID_DTD_OFFSET, ERROR) \
+	X(DI_FAILURE_CTA_NON_ZERO_PADDING, PEDANTIC) \
+	X(DI_FAILURE_DISPLAYID_UNEXPECTED_REVISION, WARNING) \
+	X(DI_FAILURE_DISPLAYID_UNEXPECTED_FLAGS, WARNING) \
+	X(DI_FAILURE_DISPLAYID_DISPLAY_PARAMS_INVALID_LENGTH, ERROR) \
+	X(DI_FAILURE_DISPLAYID_TYPE_I_TIMING_RESERVED_STEREO, WARNING) \
+	X(DI_FAILURE_DISPLAYID_TYPE_I_TIMING_UNKNOWN_ASPECT, WARNING) \
+	X(DI_FAILURE_DISPLAYID_TYPE_I_TIMING_INVALID_SIZE, ERROR) \
+	X(DI_FAILURE_DISPLAYID_DATA_BLOCK_OVERFLOW, ERROR) \
+	X(DI_FAILURE_DISPLAYID_UNKNOWN_DATA_BLOCK, WARNING) \
+	X(DI_FAILURE_DISPLAYID_NON_ZERO_FILLER, PEDANTIC) \
+	X(DI_FAILURE_DISPLAYID_NON_ZERO_PADDING, PEDANTIC)
+
+#define DI_FAILURE_SEVERITY_CONSTANT(code, severity) \
+	code##_SEVERITY = DI_FAILURE_SEVERITY_##severity,
+
+/*
+ * The <code>_SEVERITY constants used by DI_FAILURE_ENABLED().
+ */
+enum {
+	DI_FAILURE_SEVERITIES(DI_FAILURE_SEVERITY_CONSTANT)
+};
+
+#undef DI_FAILURE_SEVERITY_CONSTANT
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef HASH_H
+#define HASH_H
+
+/**
+ * Private hashing utilities.
+ *
+ * This is 64-bit FNV-1a: it isn't cryptographic, but it is stable across
+ * builds and platforms, so hashes can be stored by users.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Initial value of a hash.
+ */
+#define DI_HASH_INIT UINT64_C(0xcbf29ce484222325)
+
+/**
+ * Add data to a hash, and return the updated hash.
+ */
+uint64_t
+_di_hash_update(uint64_t hash, const void *data, size_t size);
+
+#endif
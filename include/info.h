@@ -7,10 +7,105 @@
 
 #include <libdisplay-info/info.h>
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "edid.h"
+#include "log.h"
+#include "once.h"
+
+/**
+ * Memory of a struct di_info released by di_info_destroy(), kept by its parser
+ * for the next parse.
+ */
+struct di_info_memory {
+	struct di_arena arena;
+	struct di_log_records failure_records;
+	struct di_log_buffer failure_msg_buf;
+	struct di_failure_list failures;
+};
+
+struct di_parser {
+	/* NULL for the C library */
+	const struct di_allocator *allocator;
+
+	/* Memory released by di_info_destroy(), ready to be reused */
+	struct di_info_memory *recycled;
+	size_t recycled_len, recycled_cap;
+
+	/* Parts of the blobs which are not decoded */
+	struct di_edid_skip skip;
+	bool skip_failure_msg;
+	enum di_failure_severity min_failure_severity;
+
+	/* Number of struct di_info created by the parser and not yet destroyed */
+	size_t infos_len;
+	/* Whether di_parser_destroy() has been called */
+	bool destroyed;
+};
+
+struct di_info_push_parser {
+	/* NULL for the C library */
+	const struct di_allocator *allocator;
+
+	/* NULL until the base block has been pushed */
+	struct di_info *info;
+	/* Copy of the blob, allocated from the arena of info */
+	uint8_t *raw;
+	/* Number of blocks received so far, and expected in total */
+	size_t blocks_len, blocks_count;
+
+	/* Parts of the blob which are not decoded */
+	struct di_edid_skip skip;
+	bool skip_failure_msg;
+	enum di_failure_severity min_failure_severity;
+
+	/* errno of the first failure, zero if none */
+	int err;
+};
+
 struct di_info {
+	/* Owns all of the memory below, including this struct */
+	struct di_arena arena;
+	/* The parser which created this struct, if any */
+	struct di_parser *parser;
+
+	/* The blob, a copy allocated from the arena unless owned_raw is set */
+	const uint8_t *raw;
+	size_t raw_size;
+	/* Blob handed over by di_info_parse_edid_take(), freed by
+	 * di_info_destroy() */
+	uint8_t *owned_raw;
+
 	struct di_edid *edid;
+	/* Hashes of the areas compared by di_info_diff() */
+	uint64_t area_hashes[DI_EDID_AREA_COUNT];
+	/* Returned by di_info_get_fingerprint(), without and with the whole
+	 * blob */
+	uint64_t fingerprint, blob_fingerprint;
 
+	/* Failure messages when parsing into a fixed buffer, allocated from
+	 * the arena, NULL if there are no failures */
 	char *failure_msg;
+	/* Arena bytes reserved for failure_msg */
+	size_t failure_msg_size;
+	/* Failures of the other parses, formatted into failure_msg_buf by the
+	 * first di_info_get_failure_msg() call */
+	struct di_log_records failure_records;
+	struct di_log_buffer failure_msg_buf;
+	struct di_once failure_msg_once;
+	/* Failure codes, allocated from the arena when parsing into a fixed
+	 * buffer */
+	struct di_failure_list failures;
+	/* Whether failure messages are discarded */
+	bool skip_failure_msg;
+	/* Failures less severe than this are discarded */
+	enum di_failure_severity min_failure_severity;
+
+	/* Whether the extension blocks are decoded on first access */
+	bool lazy;
 };
 
 #endif
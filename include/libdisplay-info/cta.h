@@ -10,6 +10,7 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -61,6 +62,13 @@ struct di_cta_data_block;
 const struct di_cta_data_block *const *
 di_edid_cta_get_data_blocks(const struct di_edid_cta *cta);
 
+/**
+ * Same as di_edid_cta_get_data_blocks(), but also stores the number of data
+ * blocks in len.
+ */
+const struct di_cta_data_block *const *
+di_edid_cta_get_data_blocks_span(const struct di_edid_cta *cta, size_t *len);
+
 /**
  * CTA data block tag.
  *
@@ -259,6 +267,18 @@ struct di_cta_svd {
 const struct di_cta_svd *const *
 di_cta_data_block_get_svds(const struct di_cta_data_block *block);
 
+/**
+ * Get short video descriptors from a CTA data block as a contiguous array.
+ *
+ * The number of short video descriptors is stored in len.
+ *
+ * Returns NULL and sets len to zero if the data block tag is not
+ * DI_CTA_DATA_BLOCK_VIDEO.
+ */
+const struct di_cta_svd *
+di_cta_data_block_get_svds_span(const struct di_cta_data_block *block,
+				size_t *len);
+
 enum di_cta_vesa_transfer_characteristics_usage {
 	/* White transfer characteristic */
 	DI_CTA_VESA_TRANSFER_CHARACTERISTIC_USAGE_WHITE = 0,
@@ -305,4 +325,45 @@ di_cta_data_block_get_vesa_transfer_characteristics(const struct di_cta_data_blo
 const struct di_edid_detailed_timing_def *const *
 di_edid_cta_get_detailed_timing_defs(const struct di_edid_cta *cta);
 
+/**
+ * Same as di_edid_cta_get_detailed_timing_defs(), but also stores the number
+ * of detailed timing definitions in len.
+ */
+const struct di_edid_detailed_timing_def *const *
+di_edid_cta_get_detailed_timing_defs_span(const struct di_edid_cta *cta,
+					  size_t *len);
+
+/* See <libdisplay-info/edid.h> */
+struct di_edid_view;
+
+/**
+ * A CTA-861 data block header read from a view, defined in section 7.4.
+ */
+struct di_edid_view_cta_data_block {
+	/* Tag code of the data block */
+	uint8_t tag_code;
+	/* Extended tag code if the tag code is 7, zero otherwise */
+	uint8_t extended_tag_code;
+	/* Payload after the header and the extended tag code, pointing into
+	 * the blob */
+	const uint8_t *data;
+	size_t size;
+};
+
+/**
+ * Read the next data block header of the CTA-861 extension block at the
+ * provided index of a view.
+ *
+ * offset must be zero on the first call, and is then advanced to the next
+ * data block. Nothing is decoded or copied: unknown and vendor-specific data
+ * blocks are returned too, and empty blocks with an extended tag are skipped.
+ *
+ * Returns false when there are no more data blocks, or if the extension block
+ * is not a valid CTA-861 extension block.
+ */
+bool
+di_edid_view_next_cta_data_block(const struct di_edid_view *view, size_t index,
+				 size_t *offset,
+				 struct di_edid_view_cta_data_block *data_block);
+
 #endif
@@ -10,6 +10,7 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -217,6 +218,18 @@ struct di_displayid_type_i_timing {
 const struct di_displayid_type_i_timing *const *
 di_displayid_data_block_get_type_i_timings(const struct di_displayid_data_block *data_block);
 
+/**
+ * Get type I timings from a DisplayID data block as a contiguous array.
+ *
+ * The number of type I timings is stored in len.
+ *
+ * Returns NULL and sets len to zero if the data block tag isn't
+ * DI_DISPLAYID_DATA_BLOCK_TYPE_I_TIMING.
+ */
+const struct di_displayid_type_i_timing *
+di_displayid_data_block_get_type_i_timings_span(const struct di_displayid_data_block *data_block,
+						size_t *len);
+
 /**
  * Get DisplayID data blocks.
  *
@@ -225,4 +238,12 @@ di_displayid_data_block_get_type_i_timings(const struct di_displayid_data_block
 const struct di_displayid_data_block *const *
 di_displayid_get_data_blocks(const struct di_displayid *displayid);
 
+/**
+ * Same as di_displayid_get_data_blocks(), but also stores the number of data
+ * blocks in len.
+ */
+const struct di_displayid_data_block *const *
+di_displayid_get_data_blocks_span(const struct di_displayid *displayid,
+				  size_t *len);
+
 #endif
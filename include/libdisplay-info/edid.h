@@ -351,6 +351,14 @@ di_edid_standard_timing_get_dmt(const struct di_edid_standard_timing *t);
 const struct di_edid_standard_timing *const *
 di_edid_get_standard_timings(const struct di_edid *edid);
 
+/**
+ * Get EDID standard timings as a contiguous array.
+ *
+ * The number of standard timings is stored in len.
+ */
+const struct di_edid_standard_timing *
+di_edid_get_standard_timings_span(const struct di_edid *edid, size_t *len);
+
 /**
  * Stereo viewing support.
  */
@@ -477,6 +485,13 @@ struct di_edid_detailed_timing_def {
 const struct di_edid_detailed_timing_def *const *
 di_edid_get_detailed_timing_defs(const struct di_edid *edid);
 
+/**
+ * Same as di_edid_get_detailed_timing_defs(), but also stores the number of
+ * detailed timing definitions in len.
+ */
+const struct di_edid_detailed_timing_def *const *
+di_edid_get_detailed_timing_defs_span(const struct di_edid *edid, size_t *len);
+
 /**
  * EDID display descriptor.
  */
@@ -490,6 +505,13 @@ struct di_edid_display_descriptor;
 const struct di_edid_display_descriptor *const *
 di_edid_get_display_descriptors(const struct di_edid *edid);
 
+/**
+ * Same as di_edid_get_display_descriptors(), but also stores the number of
+ * display descriptors in len.
+ */
+const struct di_edid_display_descriptor *const *
+di_edid_get_display_descriptors_span(const struct di_edid *edid, size_t *len);
+
 /**
  * EDID display descriptor tag, defined in section 3.10.3.
  */
@@ -636,6 +658,18 @@ di_edid_display_descriptor_get_range_limits(const struct di_edid_display_descrip
 const struct di_edid_standard_timing *const *
 di_edid_display_descriptor_get_standard_timings(const struct di_edid_display_descriptor *desc);
 
+/**
+ * Get standard timings from an EDID display descriptor as a contiguous array.
+ *
+ * The number of standard timings is stored in len.
+ *
+ * Returns NULL and sets len to zero if the display descriptor tag isn't
+ * DI_EDID_DISPLAY_DESCRIPTOR_STD_TIMING_IDS.
+ */
+const struct di_edid_standard_timing *
+di_edid_display_descriptor_get_standard_timings_span(const struct di_edid_display_descriptor *desc,
+						     size_t *len);
+
 /**
  * EDID Color Points, defined in section 3.10.3.5.
  */
@@ -662,6 +696,18 @@ struct di_edid_color_point {
 const struct di_edid_color_point *const *
 di_edid_display_descriptor_get_color_points(const struct di_edid_display_descriptor *desc);
 
+/**
+ * Get color points from an EDID display descriptor as a contiguous array.
+ *
+ * The number of color points is stored in len.
+ *
+ * Returns NULL and sets len to zero if the display descriptor tag isn't
+ * DI_EDID_DISPLAY_DESCRIPTOR_COLOR_POINT.
+ */
+const struct di_edid_color_point *
+di_edid_display_descriptor_get_color_points_span(const struct di_edid_display_descriptor *desc,
+						 size_t *len);
+
 /**
  * Get a list of established timings III from an EDID display descriptor.
  *
@@ -673,6 +719,17 @@ di_edid_display_descriptor_get_color_points(const struct di_edid_display_descrip
 const struct di_dmt_timing *const *
 di_edid_display_descriptor_get_established_timings_iii(const struct di_edid_display_descriptor *desc);
 
+/**
+ * Same as di_edid_display_descriptor_get_established_timings_iii(), but also
+ * stores the number of established timings III in len.
+ *
+ * Returns NULL and sets len to zero if the display descriptor tag isn't
+ * DI_EDID_DISPLAY_DESCRIPTOR_ESTABLISHED_TIMINGS_III.
+ */
+const struct di_dmt_timing *const *
+di_edid_display_descriptor_get_established_timings_iii_span(const struct di_edid_display_descriptor *desc,
+							    size_t *len);
+
 /**
  * EDID display Color Management Data, defined in section 3.10.3.7
  *
@@ -714,10 +771,20 @@ di_edid_display_descriptor_get_color_management_data(const struct di_edid_displa
  * Get a list of EDID extensions.
  *
  * The returned array is NULL-terminated.
+ *
+ * If the EDID was parsed lazily, the first call decodes the extension blocks.
+ * Concurrent first calls are safe: the blocks are decoded exactly once.
  */
 const struct di_edid_ext *const *
 di_edid_get_extensions(const struct di_edid *edid);
 
+/**
+ * Same as di_edid_get_extensions(), but also stores the number of extensions
+ * in len.
+ */
+const struct di_edid_ext *const *
+di_edid_get_extensions_span(const struct di_edid *edid, size_t *len);
+
 /**
  * EDID extension block tags, defined in section 2.2.4.
  */
@@ -774,4 +841,173 @@ struct di_displayid;
 const struct di_displayid *
 di_edid_ext_get_displayid(const struct di_edid_ext *ext);
 
+/**
+ * A read-only view over an EDID blob.
+ *
+ * Unlike struct di_edid, a view doesn't decode the blob up front and doesn't
+ * allocate memory: the di_edid_view_* functions decode fields straight from
+ * the blob on each call. This is cheaper for callers which only need a few
+ * fields. Failures are not reported, use di_info_parse_edid() to check the
+ * blob for conformance.
+ *
+ * The fields are private. Callers need to keep the blob valid while the view
+ * is in use.
+ */
+struct di_edid_view {
+	const uint8_t *data;
+	size_t size;
+};
+
+/**
+ * Initialize a view over an EDID blob.
+ *
+ * The header, the version, the checksum of the base block and the extension
+ * count are checked. The extension blocks are not checked. False is returned
+ * and errno is set if the blob is invalid.
+ */
+bool
+di_edid_view_init(struct di_edid_view *view, const void *data, size_t size);
+
+/**
+ * Same as di_edid_get_version(), for a view.
+ */
+int
+di_edid_view_get_version(const struct di_edid_view *view);
+
+/**
+ * Same as di_edid_get_revision(), for a view.
+ */
+int
+di_edid_view_get_revision(const struct di_edid_view *view);
+
+/**
+ * Same as di_edid_get_vendor_product(), for a view.
+ */
+void
+di_edid_view_get_vendor_product(const struct di_edid_view *view,
+				struct di_edid_vendor_product *vendor_product);
+
+/**
+ * Same as di_edid_get_screen_size(), for a view.
+ */
+void
+di_edid_view_get_screen_size(const struct di_edid_view *view,
+			     struct di_edid_screen_size *screen_size);
+
+/**
+ * Same as di_edid_get_chromaticity_coords(), for a view.
+ */
+void
+di_edid_view_get_chromaticity_coords(const struct di_edid_view *view,
+				     struct di_edid_chromaticity_coords *coords);
+
+/**
+ * A detailed timing definition decoded from a view.
+ *
+ * The signal type flags referenced by base point into this struct: it must
+ * not be copied.
+ */
+struct di_edid_view_detailed_timing_def {
+	struct di_edid_detailed_timing_def base;
+	struct di_edid_detailed_timing_analog_composite analog_composite;
+	struct di_edid_detailed_timing_bipolar_analog_composite bipolar_analog_composite;
+	struct di_edid_detailed_timing_digital_composite digital_composite;
+	struct di_edid_detailed_timing_digital_separate digital_separate;
+};
+
+/**
+ * Decode the detailed timing definition at the provided index in the base
+ * block, in the same order as di_edid_get_detailed_timing_defs().
+ *
+ * Returns false if there are not that many detailed timing definitions.
+ */
+bool
+di_edid_view_get_detailed_timing_def(const struct di_edid_view *view,
+				     size_t index,
+				     struct di_edid_view_detailed_timing_def *def);
+
+/**
+ * Get the number of extension blocks of a view.
+ *
+ * Unlike di_edid_get_extensions(), blocks with an unknown tag are included.
+ */
+size_t
+di_edid_view_get_extension_count(const struct di_edid_view *view);
+
+/**
+ * Get the raw tag of the extension block at the provided index.
+ *
+ * The tag may not be one of the enum values. Zero, which is not a valid
+ * extension tag, is returned if the index is out of range.
+ */
+enum di_edid_ext_tag
+di_edid_view_get_extension_tag(const struct di_edid_view *view, size_t index);
+
+/**
+ * Basic information about an EDID blob, returned by di_edid_probe().
+ */
+struct di_edid_probe_result {
+	int version, revision;
+	struct di_edid_vendor_product vendor_product;
+	/* Number of extension blocks, including blocks with an unknown tag */
+	size_t extensions_len;
+	/* Raw tags of the extension blocks, only the first extensions_len
+	 * entries are set */
+	enum di_edid_ext_tag extension_tags[255];
+};
+
+/**
+ * Check an EDID blob and extract its identification.
+ *
+ * The same checks as di_info_parse_edid() are performed up-front: the header,
+ * the version, the checksum of every block and the extension count. Nothing is
+ * allocated and no failure messages are produced, so this is cheap enough to
+ * decide whether a blob needs to be parsed again.
+ *
+ * False is returned and errno is set if the blob is invalid.
+ */
+bool
+di_edid_probe(const void *data, size_t size, struct di_edid_probe_result *out);
+
+/**
+ * Flags for di_edid_check().
+ */
+enum di_edid_check_flags {
+	/* Only check the base block. The checksums of the extension blocks are
+	 * still validated. */
+	DI_EDID_CHECK_BASE_BLOCK_ONLY = 1 << 0,
+};
+
+/**
+ * Conformance failures found by di_edid_check().
+ */
+struct di_edid_check_result {
+	/* Failures of the base block, and of extension blocks other than
+	 * CTA-861 and DisplayID */
+	size_t base_failures;
+	/* Failures of the CTA-861 extension blocks */
+	size_t cta_failures;
+	/* Failures of the DisplayID extension blocks */
+	size_t displayid_failures;
+};
+
+/**
+ * Check the conformance of an EDID blob.
+ *
+ * This runs the same checks as di_info_parse_edid(), and counts the failures
+ * instead of reporting them as failure messages. The blob is validated in a
+ * single pass: no message is formatted, no decoded data is kept and nothing is
+ * allocated. flags is a bitfield of enum di_edid_check_flags.
+ *
+ * True is returned if the blob conforms, ie. if it could be decoded without
+ * failures. Otherwise, false is returned and errno is set to EPROTO if the
+ * blob has failures, counted in the result. If the blob couldn't be decoded,
+ * errno is set like di_info_parse_edid() does instead, eg. to EINVAL for a bad
+ * header, checksum or size, and the failure counts are all zero. The result may
+ * be NULL.
+ */
+bool
+di_edid_check(const void *data, size_t size, uint32_t flags,
+	      struct di_edid_check_result *result);
+
 #endif
@@ -1,7 +1,9 @@
 #ifndef DI_INFO_H
 #define DI_INFO_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /**
  * libdisplay-info's high-level API.
@@ -21,18 +23,308 @@ struct di_info;
  * Parse an EDID blob.
  *
  * Callers do not need to keep the provided data pointer valid after calling
- * this function. Callers should destroy the returned pointer via
- * di_info_destroy().
+ * this function: a copy is kept, see di_info_get_raw_edid(). Callers should
+ * destroy the returned pointer via di_info_destroy().
  */
 struct di_info *
 di_info_parse_edid(const void *data, size_t size);
 
+/**
+ * Memory allocation callbacks.
+ *
+ * malloc and free are required, calloc is optional. Like their C library
+ * counterparts, malloc and calloc must return memory suitably aligned for any
+ * type, or NULL on failure.
+ */
+struct di_allocator {
+	void *(*malloc)(size_t size, void *user_data);
+	void *(*calloc)(size_t nmemb, size_t size, void *user_data);
+	void (*free)(void *ptr, void *user_data);
+	void *user_data;
+};
+
+/**
+ * Parts of an EDID blob which can be skipped by the parsing functions.
+ */
+enum di_parse_skip_flags {
+	/* Detailed timing definitions and display descriptors of the base
+	 * block. di_info_get_make(), di_info_get_model() and
+	 * di_info_get_serial() then fall back to the vendor & product
+	 * identification. */
+	DI_PARSE_SKIP_BASE_DESCRIPTORS = 1 << 0,
+	/* Failure messages: di_info_get_failure_msg() returns NULL and
+	 * di_info_get_failures() returns no failure. Failures are dropped as
+	 * soon as they are detected, without being formatted. */
+	DI_PARSE_SKIP_FAILURE_MSG = 1 << 1,
+};
+
+/**
+ * How much a failure departs from the relevant specifications.
+ */
+enum di_failure_severity {
+	/* Nitpick with no practical consequence, e.g. non-zero padding or
+	 * reserved bits */
+	DI_FAILURE_SEVERITY_PEDANTIC = 0,
+	/* Unexpected or unsupported value, the data is still usable */
+	DI_FAILURE_SEVERITY_WARNING = 1,
+	/* Invalid or inconsistent data, likely to be misinterpreted */
+	DI_FAILURE_SEVERITY_ERROR = 2,
+};
+
+/**
+ * Options for the parsing functions.
+ *
+ * A zero-initialized struct selects the default behavior.
+ */
+struct di_parse_options {
+	/* Allocator for all of the memory owned by the library, NULL to use
+	 * the C library. It must stay valid until the objects created with it
+	 * are destroyed. */
+	const struct di_allocator *allocator;
+	/* Pre-scan the blob to compute the exact amount of memory needed by
+	 * the parsed data, and store it in a single allocation of that size.
+	 * Failures, if any, are recorded outside of it. Ignored by
+	 * struct di_parser, which recycles its memory instead, and by
+	 * struct di_info_push_parser. */
+	bool exact_size;
+	/* Only validate the checksums of the extension blocks, and decode them
+	 * on the first di_edid_get_extensions() or di_info_get_failure_msg()
+	 * call. Extension blocks which fail to decode are reported as failure
+	 * messages instead of failing the parse. Only honored by
+	 * di_info_parse_edid_with_options(). */
+	bool lazy;
+	/* Bitfield of enum di_parse_skip_flags */
+	uint32_t skip;
+	/* Bitmask of CTA-861 data blocks to skip: bit n stands for the enum
+	 * di_cta_data_block_tag value n. Skipped data blocks are left out of
+	 * di_edid_cta_get_data_blocks(). */
+	uint64_t skip_cta_data_blocks;
+	/* Bitmask of DisplayID data blocks to skip: bit n stands for the enum
+	 * di_displayid_data_block_tag value n. Skipped data blocks are left out
+	 * of di_displayid_get_data_blocks(). */
+	uint64_t skip_displayid_data_blocks;
+	/* Failures less severe than this are dropped, as if the blob conformed
+	 * to the specifications in this regard. Failures below the
+	 * min_failure_severity build option are always dropped. */
+	enum di_failure_severity min_failure_severity;
+};
+
+/**
+ * Parse an EDID blob with options.
+ *
+ * This behaves like di_info_parse_edid(). The options may be NULL.
+ */
+struct di_info *
+di_info_parse_edid_with_options(const void *data, size_t size,
+				const struct di_parse_options *options);
+
+/**
+ * Parse an EDID blob, taking ownership of it.
+ *
+ * This behaves like di_info_parse_edid_with_options(), except that the blob
+ * is kept as-is instead of being copied, and can be retrieved with
+ * di_info_get_raw_edid(). The blob must have been allocated with the
+ * allocator of the options, or with malloc() if there is none. It is freed by
+ * di_info_destroy(), or before returning if parsing fails. The options may be
+ * NULL.
+ */
+struct di_info *
+di_info_parse_edid_take(void *data, size_t size,
+			const struct di_parse_options *options);
+
+/**
+ * Get the size of the memory region needed to parse an EDID blob with
+ * di_info_parse_edid_into().
+ *
+ * The returned size is an upper bound computed from the contents of the blob.
+ * Zero is returned and errno is set if the blob is invalid.
+ */
+size_t
+di_info_parse_edid_size(const void *data, size_t size);
+
+/**
+ * Parse an EDID blob into a caller-provided memory region.
+ *
+ * This function doesn't allocate memory: the returned struct di_info and all
+ * of the data it references are stored in the memory region, which must be at
+ * least di_info_parse_edid_size() bytes large. NULL is returned and errno is
+ * set to ENOMEM if the memory region is too small.
+ *
+ * Callers do not need to keep the provided data pointer valid after calling
+ * this function. Callers need to keep the memory region valid until
+ * di_info_destroy() is called. Failure messages are truncated if they don't
+ * fit in the space reserved for them.
+ */
+struct di_info *
+di_info_parse_edid_into(const void *data, size_t size, void *buf, size_t buf_size);
+
 /**
  * Destroy a display device information structure.
+ *
+ * If the struct di_info has been created by a struct di_parser, its memory is
+ * returned to the parser for reuse.
  */
 void
 di_info_destroy(struct di_info *info);
 
+/**
+ * A reusable parser context.
+ *
+ * Parsing many blobs with the same parser keeps memory allocations to a
+ * minimum: the memory of a struct di_info, including its failures and failure
+ * message, is recycled when it is destroyed. Once the recycled memory has
+ * grown to fit the blobs being parsed, parsing allocates nothing.
+ *
+ * A parser and the struct di_info it created must not be used concurrently
+ * from multiple threads.
+ */
+struct di_parser;
+
+/**
+ * Create a parser context.
+ *
+ * Callers should destroy the returned pointer via di_parser_destroy().
+ */
+struct di_parser *
+di_parser_create(void);
+
+/**
+ * Create a parser context with options.
+ *
+ * The options apply to all blobs parsed with the parser and may be NULL.
+ */
+struct di_parser *
+di_parser_create_with_options(const struct di_parse_options *options);
+
+/**
+ * Destroy a parser context.
+ *
+ * Each struct di_info created by the parser stays valid until it is destroyed
+ * via di_info_destroy().
+ */
+void
+di_parser_destroy(struct di_parser *parser);
+
+/**
+ * Parse an EDID blob with a parser context.
+ *
+ * This behaves like di_info_parse_edid(), but reuses the memory of previously
+ * destroyed struct di_info created by the same parser.
+ */
+struct di_info *
+di_parser_parse_edid(struct di_parser *parser, const void *data, size_t size);
+
+/**
+ * A parser for EDID blobs received one block at a time.
+ *
+ * Blocks are decoded as soon as they are pushed, so that decoding overlaps
+ * with slow transfers such as DDC reads, and the struct di_info is ready as
+ * soon as the last block has been received.
+ */
+struct di_info_push_parser;
+
+/**
+ * Create a push parser.
+ *
+ * The allocator, skip, skip_cta_data_blocks, skip_displayid_data_blocks and
+ * min_failure_severity options apply to the blob. exact_size and lazy are
+ * ignored: the blocks are always decoded as they arrive, into memory which
+ * grows as needed. The options may be NULL.
+ *
+ * Callers should either destroy the returned pointer via
+ * di_info_push_parser_destroy(), or turn it into a struct di_info via
+ * di_info_push_parser_finish().
+ */
+struct di_info_push_parser *
+di_info_push_parser_create(const struct di_parse_options *options);
+
+/**
+ * Destroy a push parser, dropping the blocks pushed so far.
+ */
+void
+di_info_push_parser_destroy(struct di_info_push_parser *parser);
+
+/**
+ * Push the next 128-byte block of an EDID blob, starting with the base block.
+ *
+ * Returns the number of blocks still expected, zero once the blob is
+ * complete. -1 is returned and errno is set if the block is invalid, or if
+ * all blocks have already been pushed. After a failure, the parser can only
+ * be destroyed.
+ */
+int
+di_info_push_parser_push_block(struct di_info_push_parser *parser,
+			       const void *block);
+
+/**
+ * Get the total number of blocks of the blob, including the base block.
+ *
+ * This is read from the base block: zero is returned until it has been
+ * pushed.
+ */
+size_t
+di_info_push_parser_get_block_count(const struct di_info_push_parser *parser);
+
+/**
+ * Get the parsed display device information.
+ *
+ * The parser is destroyed. NULL is returned and errno is set if parsing
+ * failed, or if some blocks haven't been pushed.
+ */
+struct di_info *
+di_info_push_parser_finish(struct di_info_push_parser *parser);
+
+/**
+ * Parse a new version of the EDID blob of a display device.
+ *
+ * This is meant for connectors which re-read the EDID on each hotplug event,
+ * when the blob is usually unchanged or differs in a single block. An
+ * identical blob is not parsed at all. Otherwise, extension blocks identical
+ * to the block at the same index in the previous blob are not decoded again.
+ *
+ * On success, the returned struct di_info replaces info, which must not be
+ * used anymore. Data previously returned from info is invalidated. The
+ * returned struct may be info itself: memory of the replaced data is only
+ * released by di_info_destroy(), or when it exceeds the memory of the current
+ * data and the blob is parsed from scratch.
+ *
+ * On failure, NULL is returned, errno is set and info is left untouched.
+ */
+struct di_info *
+di_info_reparse_edid(struct di_info *info, const void *data, size_t size);
+
+/**
+ * Memory held by a struct di_info, in bytes.
+ */
+struct di_info_footprint {
+	/* Base EDID block, other extension blocks and the struct di_info
+	 * itself */
+	size_t base;
+	/* CTA-861 extension blocks */
+	size_t cta;
+	/* DisplayID extension blocks */
+	size_t displayid;
+	/* Failure messages */
+	size_t failure_msg;
+	/* Allocated but unused: bookkeeping, free space and data replaced by
+	 * di_info_reparse_edid() */
+	size_t unused;
+	/* Sum of all of the above */
+	size_t total;
+};
+
+/**
+ * Get the memory footprint of a struct di_info.
+ *
+ * For a struct di_info created by di_info_parse_edid_into(), the total is the
+ * usable part of the caller-provided memory region. For a lazily parsed blob,
+ * extension blocks which haven't been decoded yet are not accounted for: this
+ * function must not be called concurrently with their decoding.
+ */
+void
+di_info_get_footprint(const struct di_info *info,
+		      struct di_info_footprint *footprint);
+
 /**
  * Returns the EDID the display device information was constructed with.
  *
@@ -46,14 +338,202 @@ di_info_destroy(struct di_info *info);
 const struct di_edid *
 di_info_get_edid(const struct di_info *info);
 
+/**
+ * Get the raw EDID blob the display device information was constructed with.
+ *
+ * The size of the blob is stored in size. The returned data is owned by the
+ * struct di_info, and is valid until di_info_destroy() or
+ * di_info_reparse_edid().
+ */
+const void *
+di_info_get_raw_edid(const struct di_info *info, size_t *size);
+
+/**
+ * Areas of the display device information compared by di_info_diff().
+ */
+enum di_info_diff_area {
+	/* Manufacturer, model, serial number and manufacture date */
+	DI_INFO_DIFF_IDENTITY = 1 << 0,
+	/* Preferred timing */
+	DI_INFO_DIFF_PREFERRED_TIMING = 1 << 1,
+	/* Supported modes and link capabilities */
+	DI_INFO_DIFF_MODES = 1 << 2,
+	/* HDR metadata */
+	DI_INFO_DIFF_HDR = 1 << 3,
+	/* Color characteristics and supported colorimetry */
+	DI_INFO_DIFF_COLORIMETRY = 1 << 4,
+	/* Display range limits */
+	DI_INFO_DIFF_RANGE_LIMITS = 1 << 5,
+	/* Audio capabilities */
+	DI_INFO_DIFF_AUDIO = 1 << 6,
+};
+
+/**
+ * Compare two display device information structures.
+ *
+ * flags is a bitfield of enum di_info_diff_area selecting the areas to
+ * compare. The selected areas which differ are returned, zero if none.
+ *
+ * Each area is compared with a hash of the EDID bytes encoding it, computed
+ * at parse time, so this is cheap even for large blobs. The same information
+ * encoded differently, for instance modes listed in another order, is
+ * reported as a difference.
+ */
+uint32_t
+di_info_diff(const struct di_info *a, const struct di_info *b, uint32_t flags);
+
+/**
+ * Flags for di_info_get_fingerprint().
+ */
+enum di_info_fingerprint_flags {
+	/* Also hash the whole blob, so that any change yields another
+	 * fingerprint */
+	DI_INFO_FINGERPRINT_FULL_BLOB = 1 << 0,
+};
+
+/**
+ * Get a 64-bit fingerprint of the display device.
+ *
+ * The fingerprint is a hash of the identification of the device: the
+ * manufacturer PNP ID, the product code, the serial number, the serial number
+ * string and the manufacture date. flags is a bitfield of enum
+ * di_info_fingerprint_flags.
+ *
+ * The fingerprint is computed at parse time. It is stable across platforms
+ * and library versions, so it can be stored, for instance to key
+ * per-display configuration. It is not a cryptographic hash.
+ */
+uint64_t
+di_info_get_fingerprint(const struct di_info *info, uint32_t flags);
+
 /**
  * Get the failure messages for this blob.
  *
  * NULL is returned if the blob conforms to the relevant specifications.
+ *
+ * The messages are formatted on the first call, the string stays valid until
+ * the info is destroyed or reparsed.
  */
 const char *
 di_info_get_failure_msg(const struct di_info *info);
 
+/**
+ * Stable identifier of a failure.
+ *
+ * Values never change across library versions, new codes are only added.
+ * Codes of the base EDID block start at 1000, codes of CTA-861 extension
+ * blocks at 2000 and codes of DisplayID extension blocks at 3000.
+ */
+enum di_failure_code {
+	/* Base EDID block */
+	DI_FAILURE_EDID_RESERVED_YEAR = 1000,
+	DI_FAILURE_EDID_INVALID_WEEK = 1001,
+	DI_FAILURE_EDID_RESERVED_VIDEO_INTERFACE = 1002,
+	DI_FAILURE_EDID_RESERVED_COLOR_BIT_DEPTH = 1003,
+	DI_FAILURE_EDID_PARTIAL_PRIMARIES = 1004,
+	DI_FAILURE_EDID_UNSET_WHITE_POINT = 1005,
+	DI_FAILURE_EDID_INVALID_STANDARD_TIMING_CODE = 1006,
+	DI_FAILURE_EDID_RESERVED_RANGE_OFFSET_FLAGS = 1007,
+	DI_FAILURE_EDID_RANGE_LIMITS_RESERVED_OFFSET_BITS = 1008,
+	DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_OFFSET = 1009,
+	DI_FAILURE_EDID_RANGE_LIMITS_RESERVED = 1010,
+	DI_FAILURE_EDID_RANGE_LIMITS_VERT_RATE_ORDER = 1011,
+	DI_FAILURE_EDID_RANGE_LIMITS_HORIZ_FREQ_ORDER = 1012,
+	DI_FAILURE_EDID_RANGE_LIMITS_NO_MAX_DOTCLOCK = 1013,
+	DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_BARE_LIMITS = 1014,
+	DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_CVT = 1015,
+	DI_FAILURE_EDID_RANGE_LIMITS_UNKNOWN_CLASS = 1016,
+	DI_FAILURE_EDID_RANGE_LIMITS_GTF_NON_CONTINUOUS = 1017,
+	DI_FAILURE_EDID_RANGE_LIMITS_CVT_NON_CONTINUOUS = 1018,
+	DI_FAILURE_EDID_RANGE_LIMITS_INVALID_BYTE_11 = 1019,
+	DI_FAILURE_EDID_RANGE_LIMITS_CVT_RESERVED_BITS = 1020,
+	DI_FAILURE_EDID_RANGE_LIMITS_CVT_INVALID_ASPECT_RATIO = 1021,
+	DI_FAILURE_EDID_RANGE_LIMITS_CVT_NO_PREFERRED_REFRESH = 1022,
+	DI_FAILURE_EDID_RANGE_LIMITS_INVALID_PADDING = 1023,
+	DI_FAILURE_EDID_STANDARD_TIMINGS_NO_LINE_FEED = 1024,
+	DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_UNSUPPORTED = 1025,
+	DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_RESERVED_BITS = 1026,
+	DI_FAILURE_EDID_RESERVED_WHITE_POINT_INDEX = 1027,
+	DI_FAILURE_EDID_INVALID_COLOR_MANAGEMENT_VERSION = 1028,
+	DI_FAILURE_EDID_INVALID_DESCRIPTOR_ORDERING = 1029,
+	DI_FAILURE_EDID_NO_PREFERRED_TIMING = 1030,
+	DI_FAILURE_EDID_UNKNOWN_DISPLAY_DESCRIPTOR = 1031,
+	DI_FAILURE_EDID_UNKNOWN_EXTENSION = 1032,
+	/* A lazily parsed extension block failed to decode */
+	DI_FAILURE_EDID_EXTENSION_DECODE_FAILED = 1033,
+
+	/* CTA-861 extension blocks */
+	DI_FAILURE_CTA_VIDEO_EMPTY = 2000,
+	DI_FAILURE_CTA_VIDEO_UNKNOWN_VIC = 2001,
+	DI_FAILURE_CTA_VIDEO_CAP_EMPTY = 2002,
+	DI_FAILURE_CTA_VIDEO_CAP_NO_SELECTABLE_RGB_QUANT = 2003,
+	DI_FAILURE_CTA_VIDEO_CAP_IT_SCAN_MISMATCH = 2004,
+	DI_FAILURE_CTA_COLORIMETRY_EMPTY = 2005,
+	DI_FAILURE_CTA_COLORIMETRY_RESERVED_BITS = 2006,
+	DI_FAILURE_CTA_HDR_STATIC_METADATA_EMPTY = 2007,
+	DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_EOTF = 2008,
+	DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_DESCRIPTOR = 2009,
+	DI_FAILURE_CTA_HDR_STATIC_METADATA_MIN_WITHOUT_MAX = 2010,
+	DI_FAILURE_CTA_INVALID_DATA_BLOCK_LENGTH = 2011,
+	DI_FAILURE_CTA_EMPTY_EXTENDED_DATA_BLOCK = 2012,
+	DI_FAILURE_CTA_UNKNOWN_EXTENDED_DATA_BLOCK = 2013,
+	DI_FAILURE_CTA_UNKNOWN_DATA_BLOCK = 2014,
+	DI_FAILURE_CTA_NON_ZERO_BYTE_3 = 2015,
+	DI_FAILURE_CTA_INVALID_DTD_OFFSET = 2016,
+	DI_FAILURE_CTA_NON_ZERO_PADDING = 2017,
+
+	/* DisplayID extension blocks */
+	DI_FAILURE_DISPLAYID_UNEXPECTED_REVISION = 3000,
+	DI_FAILURE_DISPLAYID_UNEXPECTED_FLAGS = 3001,
+	DI_FAILURE_DISPLAYID_DISPLAY_PARAMS_INVALID_LENGTH = 3002,
+	DI_FAILURE_DISPLAYID_TYPE_I_TIMING_RESERVED_STEREO = 3003,
+	DI_FAILURE_DISPLAYID_TYPE_I_TIMING_UNKNOWN_ASPECT = 3004,
+	DI_FAILURE_DISPLAYID_TYPE_I_TIMING_INVALID_SIZE = 3005,
+	DI_FAILURE_DISPLAYID_DATA_BLOCK_OVERFLOW = 3006,
+	DI_FAILURE_DISPLAYID_UNKNOWN_DATA_BLOCK = 3007,
+	DI_FAILURE_DISPLAYID_NON_ZERO_FILLER = 3008,
+	DI_FAILURE_DISPLAYID_NON_ZERO_PADDING = 3009,
+};
+
+/**
+ * A failure found in a blob, see di_info_get_failure_msg() for the
+ * human-readable description.
+ */
+struct di_failure {
+	enum di_failure_code code;
+	/* EDID block the failure was found in, 0 for the base block */
+	size_t block_index;
+};
+
+/**
+ * Get the failures found in this blob, in the order of the failure messages.
+ *
+ * The number of failures is stored in count. NULL is returned if the blob
+ * conforms to the relevant specifications. The returned array is valid until
+ * di_info_destroy() or di_info_reparse_edid().
+ *
+ * For a struct di_info created by di_info_parse_edid_into(), failures which
+ * don't fit in the caller-provided memory region are left out, like the
+ * failure messages.
+ */
+const struct di_failure *
+di_info_get_failures(const struct di_info *info, size_t *count);
+
+/**
+ * Get the severity of a failure code.
+ *
+ * Unknown codes are reported as DI_FAILURE_SEVERITY_ERROR.
+ */
+enum di_failure_severity
+di_failure_code_get_severity(enum di_failure_code code);
+
+/**
+ * Count the failures of the specified code found in this blob.
+ */
+size_t
+di_info_get_failure_count(const struct di_info *info,
+			  enum di_failure_code code);
+
 /**
  * Get the make of the display device.
  *
@@ -64,7 +544,8 @@ di_info_get_failure_msg(const struct di_info *info);
  * The string is in UTF-8 and may contain any characters except ASCII control
  * codes.
  *
- * The caller is responsible for free'ing the returned string.
+ * The caller is responsible for free'ing the returned string. It is always
+ * allocated with the C library, regardless of the parse options.
  * NULL is returned if the information is not available.
  */
 char *
@@ -80,7 +561,8 @@ di_info_get_make(const struct di_info *info);
  * The string is in UTF-8 and may contain any characters except ASCII control
  * codes.
  *
- * The caller is responsible for free'ing the returned string.
+ * The caller is responsible for free'ing the returned string. It is always
+ * allocated with the C library, regardless of the parse options.
  * NULL is returned if the information is not available.
  */
 char *
@@ -96,7 +578,8 @@ di_info_get_model(const struct di_info *info);
  * The string is in UTF-8 and may contain any characters except ASCII control
  * codes.
  *
- * The caller is responsible for free'ing the returned string.
+ * The caller is responsible for free'ing the returned string. It is always
+ * allocated with the C library, regardless of the parse options.
  * NULL is returned if the information is not available.
  */
 char *
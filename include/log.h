@@ -5,17 +5,155 @@
  * Private logging utilities.
  */
 
-#include <stdarg.h>
 #include <stdbool.h>
-#include <stdio.h>
+#include <stdint.h>
 
+#include <libdisplay-info/info.h>
+
+#include "failure.h"
+
+/**
+ * A buffer collecting failure messages.
+ *
+ * If the buffer can grow, it is reallocated as needed. Otherwise, messages
+ * which don't fit are truncated. The contents are always zero-terminated,
+ * unless data is NULL.
+ */
+struct di_log_buffer {
+	char *data;
+	size_t size, len;
+	bool can_grow;
+	/* Used to grow the buffer, NULL for the C library */
+	const struct di_allocator *allocator;
+};
+
+/**
+ * A list of failure codes.
+ *
+ * If the list can grow, it is reallocated as needed. Otherwise, failures which
+ * don't fit are dropped.
+ */
+struct di_failure_list {
+	struct di_failure *data;
+	size_t len, cap;
+	bool can_grow;
+	/* Used to grow the list, NULL for the C library */
+	const struct di_allocator *allocator;
+};
+
+/**
+ * Number of integer arguments of a failure message. The message of each
+ * failure code defines how many are used and what they mean, the others are
+ * zero.
+ */
+#define DI_LOG_MAX_ARGS 3
+
+/**
+ * A failure, formatted later on.
+ */
+struct di_log_record {
+	enum di_failure_code code;
+	/* The section is "Block <block_index>, <section>" */
+	size_t block_index;
+	const char *section;
+	/* Whether this is the first failure of its section */
+	bool new_section;
+	uintmax_t args[DI_LOG_MAX_ARGS];
+};
+
+/**
+ * A growable array of failures.
+ */
+struct di_log_records {
+	struct di_log_record *data;
+	size_t len, cap;
+	/* NULL for the C library */
+	const struct di_allocator *allocator;
+};
+
+/**
+ * Failure messages are written to buf if set, to records otherwise. If both
+ * are NULL, failure messages are discarded without being formatted.
+ *
+ * Failure codes are appended to failures if set.
+ *
+ * Failures less severe than min_severity are dropped altogether.
+ */
 struct di_logger {
-	FILE *f;
+	struct di_log_buffer *buf;
+	struct di_log_records *records;
+	struct di_failure_list *failures;
+	/* Section of the messages: "Block <block_index>, <section>", section
+	 * must be a static string */
+	size_t block_index;
 	const char *section;
 	bool initialized;
+	/* Incremented for each failure if set */
+	size_t *failure_count;
+	enum di_failure_severity min_severity;
 };
 
+/**
+ * Add a failure. Its message is made from the failure code and the arguments.
+ */
+void
+_di_logger_add_failure(struct di_logger *logger, enum di_failure_code code,
+		       const uintmax_t args[static_array DI_LOG_MAX_ARGS]);
+
+/**
+ * Append a section of failure messages previously written to a buffer.
+ *
+ * The section must not include the separator from the previous section.
+ */
+void
+_di_log_buffer_add_section(struct di_log_buffer *buf, const char *section,
+			   size_t len);
+
+/**
+ * Format failures, with the same output as a struct di_logger writing to buf.
+ */
+void
+_di_log_records_format(const struct di_log_records *records,
+		       struct di_log_buffer *buf);
+
+/**
+ * Append a copy of the failures of a section, starting with its first
+ * failure, previously recorded to another array.
+ *
+ * Returns false on allocation failure, leaving records untouched.
+ */
+bool
+_di_log_records_add_section(struct di_log_records *records,
+			    const struct di_log_records *src, size_t start,
+			    size_t len);
+
+/**
+ * Release the memory used by failures.
+ */
+void
+_di_log_records_finish(struct di_log_records *records);
+
+/**
+ * Make room for len more failures.
+ *
+ * Returns false on allocation failure. Lists which can't grow always succeed,
+ * failures which don't fit are then dropped.
+ */
+bool
+_di_failure_list_reserve(struct di_failure_list *failures, size_t len);
+
+/**
+ * Append failures previously added to another list.
+ */
+void
+_di_failure_list_add_section(struct di_failure_list *failures,
+			     const struct di_failure_list *src, size_t start,
+			     size_t len);
+
+/**
+ * Release the memory used by a list which can grow.
+ */
 void
-_di_logger_va_add_failure(struct di_logger *logger, const char fmt[], va_list args);
+_di_failure_list_finish(struct di_failure_list *failures);
 
 #endif
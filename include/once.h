@@ -0,0 +1,39 @@
+#ifndef ONCE_H
+#define ONCE_H
+
+/**
+ * Private one-time initialization utilities.
+ *
+ * Used to lazily compute data from const getters which may be called
+ * concurrently from multiple threads.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * A one-time initialization guard.
+ *
+ * A zero-initialized struct is ready for use.
+ */
+struct di_once {
+	atomic_int state;
+};
+
+/**
+ * Start a one-time initialization.
+ *
+ * Returns true if the caller must perform the initialization and then call
+ * _di_once_leave(). Returns false once the initialization has completed,
+ * waiting for it if another thread is performing it.
+ */
+bool
+_di_once_enter(struct di_once *once);
+
+/**
+ * Mark a one-time initialization as completed.
+ */
+void
+_di_once_leave(struct di_once *once);
+
+#endif
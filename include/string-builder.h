@@ -0,0 +1,61 @@
+#ifndef STRING_BUILDER_H
+#define STRING_BUILDER_H
+
+/**
+ * Private string building utilities.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <libdisplay-info/info.h>
+
+/**
+ * Size of the storage embedded in struct di_string_builder. This is enough
+ * to hold most make, model and serial strings without allocating.
+ */
+#define DI_STRING_BUILDER_INLINE_SIZE 64
+
+/**
+ * A growable string.
+ *
+ * Short strings are stored in the struct itself, which must then not be
+ * copied. The contents are always zero-terminated. If an allocation fails,
+ * further appends are ignored and _di_string_builder_finish() returns NULL.
+ */
+struct di_string_builder {
+	char *data;
+	size_t len, size;
+	bool failed;
+	/* NULL for the C library */
+	const struct di_allocator *allocator;
+	char inline_data[DI_STRING_BUILDER_INLINE_SIZE];
+};
+
+void
+_di_string_builder_init(struct di_string_builder *sb,
+			const struct di_allocator *allocator);
+
+void
+_di_string_builder_append(struct di_string_builder *sb, const char *str,
+			  size_t len);
+
+void
+_di_string_builder_append_char(struct di_string_builder *sb, char c);
+
+void
+_di_string_builder_va_printf(struct di_string_builder *sb, const char fmt[],
+			     va_list args);
+
+void
+_di_string_builder_printf(struct di_string_builder *sb, const char fmt[], ...);
+
+/**
+ * Get the string, allocated with the allocator of the builder, and release
+ * the builder. NULL is returned if an allocation failed.
+ */
+char *
+_di_string_builder_finish(struct di_string_builder *sb);
+
+#endif
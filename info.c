@@ -1,60 +1,767 @@
+#include <errno.h>
 #include <inttypes.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
+#include "allocator.h"
+#include "arena.h"
 #include "edid.h"
+#include "hash.h"
 #include "info.h"
 #include "log.h"
-#include "memory-stream.h"
+#include "string-builder.h"
+
+/**
+ * Size of the first arena chunk. This is enough to hold the parsed data
+ * structures of most EDID blobs.
+ */
+#define INFO_ARENA_CHUNK_SIZE (4 * 1024)
+/**
+ * Space reserved for failure messages per EDID block, when parsing into a
+ * caller-provided buffer.
+ */
+#define INFO_FAILURE_MSG_SIZE_PER_BLOCK 2048
+/**
+ * Failure codes reserved per EDID block, when parsing into a caller-provided
+ * buffer.
+ */
+#define INFO_FAILURES_PER_BLOCK 32
 
 /* Generated file pnp-id-table.c: */
 const char *
 pnp_id_table(const char *key);
 
+static size_t
+get_failure_msg_buffer_size(size_t edid_size)
+{
+	return (edid_size / EDID_BLOCK_SIZE) * INFO_FAILURE_MSG_SIZE_PER_BLOCK;
+}
+
+static size_t
+get_failure_list_size(size_t edid_size)
+{
+	return (edid_size / EDID_BLOCK_SIZE) * INFO_FAILURES_PER_BLOCK
+	       * sizeof(struct di_failure);
+}
+
+/**
+ * Allocate the failure message buffer and the failure code list from the arena
+ * of an info parsed into a fixed buffer. Returns the arena bytes reserved.
+ */
+static size_t
+alloc_fixed_failures(struct di_info *info, size_t edid_size,
+		     struct di_log_buffer *failure_msg,
+		     struct di_failure_list *failures)
+{
+	size_t failures_size;
+
+	failure_msg->size = get_failure_msg_buffer_size(edid_size);
+	failure_msg->data = _di_arena_alloc(&info->arena, failure_msg->size);
+	if (!failure_msg->data)
+		return 0;
+
+	failures_size = get_failure_list_size(edid_size);
+	failures->data = _di_arena_alloc(&info->arena, failures_size);
+	if (!failures->data)
+		return 0;
+	failures->cap = failures_size / sizeof(*failures->data);
+
+	return _di_arena_get_alloc_size(failure_msg->size) +
+	       _di_arena_get_alloc_size(failures_size);
+}
+
+static void
+get_edid_skip(const struct di_parse_options *options, struct di_edid_skip *skip)
+{
+	*skip = (struct di_edid_skip) {0};
+	if (!options)
+		return;
+
+	skip->base_descriptors = options->skip & DI_PARSE_SKIP_BASE_DESCRIPTORS;
+	skip->cta_data_blocks = options->skip_cta_data_blocks;
+	skip->displayid_data_blocks = options->skip_displayid_data_blocks;
+}
+
+static bool
+set_raw(struct di_info *info, const void *data, size_t size)
+{
+	uint8_t *raw;
+
+	raw = _di_arena_alloc(&info->arena, size);
+	if (!raw)
+		return false;
+	memcpy(raw, data, size);
+	info->raw = raw;
+	info->raw_size = size;
+	return true;
+}
+
+/**
+ * Compute the hashes of the blob, once it has been parsed.
+ */
+static void
+set_hashes(struct di_info *info)
+{
+	_di_edid_hash_areas(info->raw, info->raw_size, info->area_hashes);
+	info->fingerprint = _di_edid_hash_identity(info->raw, info->raw_size);
+	info->blob_fingerprint = _di_hash_update(info->fingerprint, info->raw,
+						 info->raw_size);
+}
+
+/**
+ * Get the destination of the failures of a parse, NULL if they are discarded.
+ *
+ * Failures are recorded to the info, and only formatted if the failure
+ * message is requested.
+ */
+static const struct di_logger *
+get_failure_logger(struct di_info *info, struct di_logger *logger)
+{
+	if (info->skip_failure_msg)
+		return NULL;
+
+	/* The lists may have been recycled by a parser: keep their memory */
+	info->failure_records.allocator = info->arena.allocator;
+	info->failures.can_grow = true;
+	info->failures.allocator = info->arena.allocator;
+	*logger = (struct di_logger) {
+		.records = &info->failure_records,
+		.failures = &info->failures,
+		.min_severity = info->min_failure_severity,
+	};
+	return logger;
+}
+
 struct di_info *
 di_info_parse_edid(const void *data, size_t size)
 {
-	struct di_edid *edid;
+	return di_info_parse_edid_with_options(data, size, NULL);
+}
+
+/**
+ * Parse a blob, either copied into the arena or used in place if owned_data
+ * is set. The info only takes ownership of owned_data on success.
+ */
+static struct di_info *
+parse_edid(const void *data, size_t size, uint8_t *owned_data,
+	   const struct di_parse_options *options)
+{
+	const struct di_allocator *allocator;
+	struct di_arena arena;
 	struct di_info *info;
-	struct memory_stream failure_msg;
+	struct di_logger logger;
+	struct di_edid_skip skip;
+	size_t chunk_size, parse_size;
+	bool lazy, skip_failure_msg;
+	int err;
+
+	allocator = options ? options->allocator : NULL;
+	lazy = options && options->lazy;
+	skip_failure_msg = options && (options->skip & DI_PARSE_SKIP_FAILURE_MSG);
+	get_edid_skip(options, &skip);
+
+	chunk_size = INFO_ARENA_CHUNK_SIZE;
+	if (options && options->exact_size) {
+		parse_size = _di_edid_get_parse_size(data, size);
+		if (parse_size == 0)
+			return NULL;
+		chunk_size = _di_arena_get_alloc_size(sizeof(*info)) + parse_size;
+		if (!owned_data)
+			chunk_size += _di_arena_get_alloc_size(size);
+	}
 
-	if (!memory_stream_open(&failure_msg))
+	_di_arena_init(&arena, chunk_size, allocator);
+	info = _di_arena_alloc(&arena, sizeof(*info));
+	if (!info)
+		return NULL;
+	info->arena = arena;
+	info->skip_failure_msg = skip_failure_msg;
+	if (options)
+		info->min_failure_severity = options->min_failure_severity;
+
+	if (owned_data) {
+		info->raw = owned_data;
+		info->raw_size = size;
+	} else if (!set_raw(info, data, size)) {
+		err = errno;
+		di_info_destroy(info);
+		errno = err;
 		return NULL;
+	}
+
+	/* Lazily decoded extension blocks record their failures later on */
+	info->lazy = lazy;
+	info->edid = _di_edid_parse(&info->arena, info->raw, size,
+				    get_failure_logger(info, &logger), lazy,
+				    &skip);
+	if (!info->edid) {
+		err = errno;
+		di_info_destroy(info);
+		errno = err;
+		return NULL;
+	}
+
+	info->owned_raw = owned_data;
+	set_hashes(info);
+	return info;
+}
+
+struct di_info *
+di_info_parse_edid_with_options(const void *data, size_t size,
+				const struct di_parse_options *options)
+{
+	return parse_edid(data, size, NULL, options);
+}
+
+struct di_info *
+di_info_parse_edid_take(void *data, size_t size,
+			const struct di_parse_options *options)
+{
+	struct di_info *info;
+	int err;
+
+	info = parse_edid(data, size, data, options);
+	if (!info) {
+		err = errno;
+		_di_free(options ? options->allocator : NULL, data);
+		errno = err;
+	}
+	return info;
+}
+
+size_t
+di_info_parse_edid_size(const void *data, size_t size)
+{
+	size_t parse_size;
+
+	parse_size = _di_edid_get_parse_size(data, size);
+	if (parse_size == 0)
+		return 0;
+
+	parse_size += _di_arena_get_alloc_size(sizeof(struct di_info));
+	parse_size += _di_arena_get_alloc_size(size);
+	parse_size += _di_arena_get_alloc_size(get_failure_msg_buffer_size(size));
+	parse_size += _di_arena_get_alloc_size(get_failure_list_size(size));
+	return _di_arena_get_buffer_size(parse_size);
+}
+
+struct di_info *
+di_info_parse_edid_into(const void *data, size_t size, void *buf, size_t buf_size)
+{
+	struct di_arena arena;
+	struct di_info *info;
+	struct di_log_buffer failure_msg = {0};
+	struct di_logger logger = {0};
+	size_t failure_msg_size;
 
-	edid = _di_edid_parse(data, size, failure_msg.fp);
-	if (!edid)
-		goto err_failure_msg_file;
+	if (!_di_arena_init_buffer(&arena, buf, buf_size)) {
+		errno = ENOMEM;
+		return NULL;
+	}
 
-	info = calloc(1, sizeof(*info));
+	info = _di_arena_alloc(&arena, sizeof(*info));
 	if (!info)
-		goto err_edid;
+		return NULL;
+	info->arena = arena;
 
-	info->edid = edid;
+	if (!set_raw(info, data, size))
+		return NULL;
 
-	if (fflush(failure_msg.fp) != 0)
-		goto err_info;
+	failure_msg_size = alloc_fixed_failures(info, size, &failure_msg,
+						&info->failures);
+	if (failure_msg_size == 0)
+		return NULL;
 
-	info->failure_msg = memory_stream_close(&failure_msg);
+	logger.buf = &failure_msg;
+	logger.failures = &info->failures;
+	info->edid = _di_edid_parse(&info->arena, data, size, &logger, false,
+				    NULL);
+	if (!info->edid)
+		return NULL;
+
+	if (failure_msg.len > 0)
+		info->failure_msg = failure_msg.data;
+	info->failure_msg_size = failure_msg_size;
+	set_hashes(info);
 
 	return info;
+}
 
-err_info:
-	free(info);
-err_edid:
-	_di_edid_destroy(edid);
-err_failure_msg_file:
-	memory_stream_close(&failure_msg);
-	return NULL;
+struct di_parser *
+di_parser_create(void)
+{
+	return di_parser_create_with_options(NULL);
+}
+
+struct di_parser *
+di_parser_create_with_options(const struct di_parse_options *options)
+{
+	const struct di_allocator *allocator;
+	struct di_parser *parser;
+
+	allocator = options ? options->allocator : NULL;
+
+	parser = _di_calloc(allocator, 1, sizeof(*parser));
+	if (!parser)
+		return NULL;
+
+	parser->allocator = allocator;
+	get_edid_skip(options, &parser->skip);
+	parser->skip_failure_msg = options &&
+				   (options->skip & DI_PARSE_SKIP_FAILURE_MSG);
+	if (options)
+		parser->min_failure_severity = options->min_failure_severity;
+	return parser;
+}
+
+/**
+ * Get the memory owned by an info, including the info itself.
+ */
+static struct di_info_memory
+get_info_memory(const struct di_info *info)
+{
+	return (struct di_info_memory) {
+		.arena = info->arena,
+		.failure_records = info->failure_records,
+		.failure_msg_buf = info->failure_msg_buf,
+		.failures = info->failures,
+	};
+}
+
+static void
+info_memory_finish(struct di_info_memory *mem)
+{
+	_di_log_records_finish(&mem->failure_records);
+	_di_free(mem->arena.allocator, mem->failure_msg_buf.data);
+	/* Otherwise, the failures are allocated from the arena */
+	if (mem->failures.can_grow)
+		_di_failure_list_finish(&mem->failures);
+	_di_arena_finish(&mem->arena);
+}
+
+static void
+parser_free(struct di_parser *parser)
+{
+	size_t i;
+
+	for (i = 0; i < parser->recycled_len; i++)
+		info_memory_finish(&parser->recycled[i]);
+	_di_free(parser->allocator, parser->recycled);
+	_di_free(parser->allocator, parser);
+}
+
+void
+di_parser_destroy(struct di_parser *parser)
+{
+	/* Outstanding struct di_info still reference the parser */
+	if (parser->infos_len > 0) {
+		parser->destroyed = true;
+		return;
+	}
+
+	parser_free(parser);
+}
+
+/**
+ * Keep the memory of an info for the next parse, emptied but not freed.
+ */
+static void
+parser_recycle(struct di_parser *parser, struct di_info_memory *mem)
+{
+	struct di_info_memory *recycled;
+	size_t cap;
+
+	if (parser->recycled_len == parser->recycled_cap) {
+		cap = parser->recycled_cap > 0 ? parser->recycled_cap * 2 : 4;
+		recycled = _di_realloc(parser->allocator, parser->recycled,
+				       parser->recycled_cap * sizeof(*recycled),
+				       cap * sizeof(*recycled));
+		if (!recycled) {
+			info_memory_finish(mem);
+			return;
+		}
+		parser->recycled = recycled;
+		parser->recycled_cap = cap;
+	}
+
+	_di_arena_reset(&mem->arena);
+	mem->failure_records.len = 0;
+	mem->failure_msg_buf.len = 0;
+	mem->failures.len = 0;
+	parser->recycled[parser->recycled_len++] = *mem;
+}
+
+struct di_info *
+di_parser_parse_edid(struct di_parser *parser, const void *data, size_t size)
+{
+	struct di_info_memory mem = {0};
+	struct di_info *info;
+	struct di_logger logger;
+	int err;
+
+	if (parser->recycled_len > 0)
+		mem = parser->recycled[--parser->recycled_len];
+	else
+		_di_arena_init(&mem.arena, INFO_ARENA_CHUNK_SIZE, parser->allocator);
+
+	info = _di_arena_alloc(&mem.arena, sizeof(*info));
+	if (!info) {
+		err = errno;
+		parser_recycle(parser, &mem);
+		errno = err;
+		return NULL;
+	}
+	info->arena = mem.arena;
+	info->failure_records = mem.failure_records;
+	info->failure_msg_buf = mem.failure_msg_buf;
+	info->failures = mem.failures;
+	info->skip_failure_msg = parser->skip_failure_msg;
+	info->min_failure_severity = parser->min_failure_severity;
+
+	if (set_raw(info, data, size))
+		info->edid = _di_edid_parse(&info->arena, data, size,
+					    get_failure_logger(info, &logger),
+					    false, &parser->skip);
+	if (!info->edid) {
+		err = errno;
+		mem = get_info_memory(info);
+		parser_recycle(parser, &mem);
+		errno = err;
+		return NULL;
+	}
+
+	set_hashes(info);
+	info->parser = parser;
+	parser->infos_len++;
+	return info;
+}
+
+struct di_info_push_parser *
+di_info_push_parser_create(const struct di_parse_options *options)
+{
+	const struct di_allocator *allocator;
+	struct di_info_push_parser *parser;
+
+	allocator = options ? options->allocator : NULL;
+
+	parser = _di_calloc(allocator, 1, sizeof(*parser));
+	if (!parser)
+		return NULL;
+
+	parser->allocator = allocator;
+	get_edid_skip(options, &parser->skip);
+	parser->skip_failure_msg = options &&
+				   (options->skip & DI_PARSE_SKIP_FAILURE_MSG);
+	if (options)
+		parser->min_failure_severity = options->min_failure_severity;
+	return parser;
+}
+
+void
+di_info_push_parser_destroy(struct di_info_push_parser *parser)
+{
+	if (parser->info)
+		di_info_destroy(parser->info);
+	_di_free(parser->allocator, parser);
+}
+
+static bool
+push_base_block(struct di_info_push_parser *parser, const uint8_t *data)
+{
+	struct di_arena arena;
+	struct di_info *info;
+	struct di_logger logger;
+	size_t blocks_count;
+	int err;
+
+	/* The extension count is checked by _di_edid_parse_base_block() */
+	blocks_count = (size_t) data[0x7E] + 1;
+
+	_di_arena_init(&arena, INFO_ARENA_CHUNK_SIZE, parser->allocator);
+	info = _di_arena_alloc(&arena, sizeof(*info));
+	if (!info)
+		return false;
+	info->arena = arena;
+	info->skip_failure_msg = parser->skip_failure_msg;
+	info->min_failure_severity = parser->min_failure_severity;
+
+	parser->raw = _di_arena_alloc(&info->arena, blocks_count * EDID_BLOCK_SIZE);
+	if (parser->raw) {
+		memcpy(parser->raw, data, EDID_BLOCK_SIZE);
+		info->edid = _di_edid_parse_base_block(&info->arena, parser->raw,
+						       get_failure_logger(info, &logger),
+						       &parser->skip);
+	}
+	if (!info->edid) {
+		err = errno;
+		di_info_destroy(info);
+		errno = err;
+		return false;
+	}
+
+	parser->info = info;
+	parser->blocks_len = 1;
+	parser->blocks_count = blocks_count;
+	return true;
+}
+
+int
+di_info_push_parser_push_block(struct di_info_push_parser *parser,
+			       const void *block)
+{
+	uint8_t *block_data;
+
+	if (parser->err) {
+		errno = parser->err;
+		return -1;
+	}
+
+	if (parser->info && parser->blocks_len == parser->blocks_count) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!parser->info) {
+		if (!push_base_block(parser, block))
+			goto err;
+	} else {
+		block_data = &parser->raw[parser->blocks_len * EDID_BLOCK_SIZE];
+		memcpy(block_data, block, EDID_BLOCK_SIZE);
+		if (!_di_edid_parse_ext_block(parser->info->edid,
+					      parser->blocks_len, block_data))
+			goto err;
+		parser->blocks_len++;
+	}
+
+	return (int) (parser->blocks_count - parser->blocks_len);
+
+err:
+	parser->err = errno;
+	return -1;
+}
+
+size_t
+di_info_push_parser_get_block_count(const struct di_info_push_parser *parser)
+{
+	return parser->blocks_count;
+}
+
+struct di_info *
+di_info_push_parser_finish(struct di_info_push_parser *parser)
+{
+	struct di_info *info;
+	int err;
+
+	if (parser->err || !parser->info ||
+	    parser->blocks_len < parser->blocks_count) {
+		err = parser->err ? parser->err : EINVAL;
+		di_info_push_parser_destroy(parser);
+		errno = err;
+		return NULL;
+	}
+
+	info = parser->info;
+	_di_edid_finish_parse(info->edid);
+	info->raw = parser->raw;
+	info->raw_size = parser->blocks_count * EDID_BLOCK_SIZE;
+	set_hashes(info);
+	parser->info = NULL;
+	di_info_push_parser_destroy(parser);
+	return info;
 }
 
 void
 di_info_destroy(struct di_info *info)
 {
-	_di_edid_destroy(info->edid);
-	free(info->failure_msg);
-	free(info);
+	struct di_info_memory mem;
+	struct di_parser *parser;
+
+	/* The arena owns the struct di_info itself */
+	mem = get_info_memory(info);
+	parser = info->parser;
+
+	_di_free(mem.arena.allocator, info->owned_raw);
+
+	if (!parser) {
+		info_memory_finish(&mem);
+		return;
+	}
+
+	parser->infos_len--;
+	if (parser->destroyed) {
+		info_memory_finish(&mem);
+		if (parser->infos_len == 0)
+			parser_free(parser);
+		return;
+	}
+
+	parser_recycle(parser, &mem);
+}
+
+/**
+ * Get the arena bytes referenced by the info. The rest of the used arena bytes
+ * belong to data replaced by di_info_reparse_edid().
+ */
+static size_t
+get_live_size(const struct di_info *info)
+{
+	size_t size;
+
+	size = _di_arena_get_alloc_size(sizeof(*info)) + info->failure_msg_size;
+	if (!info->owned_raw)
+		size += _di_arena_get_alloc_size(info->raw_size);
+	if (info->edid)
+		size += info->edid->parse_size;
+	return size;
+}
+
+struct di_info *
+di_info_reparse_edid(struct di_info *info, const void *data, size_t size)
+{
+	struct di_parse_options options;
+	struct di_info *new_info;
+	struct di_edid *edid;
+	struct di_edid_reparse_src src;
+	struct di_log_buffer failure_msg = {0};
+	struct di_log_records failure_records = {0};
+	struct di_failure_list failures = {0};
+	struct di_logger logger = {0};
+	const uint8_t *raw;
+	size_t raw_size, live, failure_msg_size = 0;
+	int err;
+
+	if (size == info->raw_size && memcmp(data, info->raw, size) == 0)
+		return info;
+
+	/* Lazily parsed blobs have little to reuse. Otherwise, start over once
+	 * the replaced data takes more memory than the current data. */
+	live = get_live_size(info);
+	if (info->lazy || (!info->arena.fixed &&
+			   _di_arena_get_used(&info->arena) - live > live)) {
+		if (info->parser && !info->parser->destroyed) {
+			new_info = di_parser_parse_edid(info->parser, data, size);
+		} else {
+			options = (struct di_parse_options) {
+				.allocator = info->arena.allocator,
+				.lazy = info->lazy,
+				.skip_cta_data_blocks = info->edid->skip.cta_data_blocks,
+				.skip_displayid_data_blocks = info->edid->skip.displayid_data_blocks,
+				.min_failure_severity = info->min_failure_severity,
+			};
+			if (info->edid->skip.base_descriptors)
+				options.skip |= DI_PARSE_SKIP_BASE_DESCRIPTORS;
+			if (info->skip_failure_msg)
+				options.skip |= DI_PARSE_SKIP_FAILURE_MSG;
+			new_info = di_info_parse_edid_with_options(data, size,
+								   &options);
+		}
+		if (!new_info)
+			return NULL;
+		di_info_destroy(info);
+		return new_info;
+	}
+
+	src = (struct di_edid_reparse_src) {
+		.edid = info->edid,
+		.data = info->raw,
+		.size = info->raw_size,
+		.failure_msg = info->failure_msg,
+		.failure_msg_len = info->failure_msg ? strlen(info->failure_msg) : 0,
+		.failure_records = &info->failure_records,
+		.failures = &info->failures,
+	};
+
+	/* Only commit the changes once everything succeeded, so that the info
+	 * stays valid on failure */
+	raw = info->raw;
+	raw_size = info->raw_size;
+	if (!set_raw(info, data, size))
+		return NULL;
+
+	if (info->arena.fixed) {
+		/* Don't allocate memory outside of the caller's buffer */
+		failure_msg_size = alloc_fixed_failures(info, size, &failure_msg,
+							&failures);
+		if (failure_msg_size == 0)
+			goto err;
+		logger.buf = &failure_msg;
+	} else {
+		failure_records.allocator = info->arena.allocator;
+		failures.can_grow = true;
+		failures.allocator = info->arena.allocator;
+		logger.records = &failure_records;
+	}
+	logger.failures = &failures;
+	logger.min_severity = info->min_failure_severity;
+
+	edid = _di_edid_reparse(&info->arena, info->raw, size,
+				info->skip_failure_msg ? NULL : &logger, &src);
+	if (!edid) {
+		err = errno;
+		_di_log_records_finish(&failure_records);
+		if (failures.can_grow)
+			_di_failure_list_finish(&failures);
+		errno = err;
+		goto err;
+	}
+
+	if (info->arena.fixed) {
+		info->failure_msg = failure_msg.len > 0 ? failure_msg.data : NULL;
+		info->failure_msg_size = failure_msg_size;
+	} else {
+		/* The new failures are formatted on the next request */
+		_di_log_records_finish(&info->failure_records);
+		info->failure_records = failure_records;
+		_di_free(info->arena.allocator, info->failure_msg_buf.data);
+		info->failure_msg_buf = (struct di_log_buffer) {0};
+		info->failure_msg_once = (struct di_once) {0};
+		_di_failure_list_finish(&info->failures);
+	}
+	info->failures = failures;
+
+	info->edid = edid;
+	set_hashes(info);
+	/* The blob has been copied into the arena by set_raw() */
+	_di_free(info->arena.allocator, info->owned_raw);
+	info->owned_raw = NULL;
+	return info;
+
+err:
+	info->raw = raw;
+	info->raw_size = raw_size;
+	return NULL;
+}
+
+void
+di_info_get_footprint(const struct di_info *info,
+		      struct di_info_footprint *footprint)
+{
+	size_t live, records_size;
+
+	*footprint = (struct di_info_footprint) {
+		.failure_msg = info->failure_msg_size,
+		.total = _di_arena_get_reserved(&info->arena),
+	};
+
+	if (info->edid) {
+		footprint->cta = info->edid->cta_parse_size;
+		footprint->displayid = info->edid->displayid_parse_size;
+	}
+
+	live = get_live_size(info);
+	footprint->base = live - footprint->cta - footprint->displayid
+			  - footprint->failure_msg;
+	footprint->unused = footprint->total - live;
+
+	/* Recorded failures are kept out of the arena */
+	records_size = info->failure_records.cap
+		       * sizeof(*info->failure_records.data)
+		       + info->failure_msg_buf.size;
+	if (info->failures.can_grow)
+		records_size += info->failures.cap * sizeof(*info->failures.data);
+	footprint->failure_msg += records_size;
+	footprint->total += records_size;
 }
 
 const struct di_edid *
@@ -63,14 +770,94 @@ di_info_get_edid(const struct di_info *info)
 	return info->edid;
 }
 
+uint32_t
+di_info_diff(const struct di_info *a, const struct di_info *b, uint32_t flags)
+{
+	uint32_t diff = 0;
+	size_t i;
+
+	for (i = 0; i < DI_EDID_AREA_COUNT; i++) {
+		if (a->area_hashes[i] != b->area_hashes[i])
+			diff |= (uint32_t) 1 << i;
+	}
+
+	return diff & flags;
+}
+
+uint64_t
+di_info_get_fingerprint(const struct di_info *info, uint32_t flags)
+{
+	if (flags & DI_INFO_FINGERPRINT_FULL_BLOB)
+		return info->blob_fingerprint;
+	return info->fingerprint;
+}
+
+const void *
+di_info_get_raw_edid(const struct di_info *info, size_t *size)
+{
+	*size = info->raw_size;
+	return info->raw;
+}
+
 const char *
 di_info_get_failure_msg(const struct di_info *info)
 {
-	return info->failure_msg;
+	struct di_info *mut_info;
+
+	if (info->arena.fixed)
+		return info->failure_msg;
+
+	/* Decoding the extension blocks completes the failures */
+	if (info->lazy)
+		di_edid_get_extensions(info->edid);
+
+	/* The info is allocated from a mutable arena */
+	mut_info = (struct di_info *) info;
+	if (_di_once_enter(&mut_info->failure_msg_once)) {
+		/* The buffer may have been recycled by a parser */
+		mut_info->failure_msg_buf.can_grow = true;
+		mut_info->failure_msg_buf.allocator = info->arena.allocator;
+		_di_log_records_format(&info->failure_records,
+				       &mut_info->failure_msg_buf);
+		_di_once_leave(&mut_info->failure_msg_once);
+	}
+
+	if (info->failure_msg_buf.len == 0)
+		return NULL;
+	return info->failure_msg_buf.data;
+}
+
+const struct di_failure *
+di_info_get_failures(const struct di_info *info, size_t *count)
+{
+	/* Decoding the extension blocks completes the failures */
+	if (info->lazy)
+		di_edid_get_extensions(info->edid);
+
+	*count = info->failures.len;
+	if (info->failures.len == 0)
+		return NULL;
+	return info->failures.data;
+}
+
+size_t
+di_info_get_failure_count(const struct di_info *info,
+			  enum di_failure_code code)
+{
+	const struct di_failure *failures;
+	size_t len, count = 0, i;
+
+	failures = di_info_get_failures(info, &len);
+	for (i = 0; i < len; i++) {
+		if (failures[i].code == code)
+			count++;
+	}
+
+	return count;
 }
 
 static void
-encode_ascii_byte(FILE *out, char ch)
+encode_ascii_byte(struct di_string_builder *out, char ch)
 {
 	uint8_t c = (uint8_t)ch;
 
@@ -80,13 +867,13 @@ encode_ascii_byte(FILE *out, char ch)
 	 * UTF-8.
 	 */
 	if (c < 0x20 || c >= 0x7f)
-		fprintf(out, "\\x%02x", c);
+		_di_string_builder_printf(out, "\\x%02x", c);
 	else
-		fputc(c, out);
+		_di_string_builder_append_char(out, ch);
 }
 
 static void
-encode_ascii_string(FILE *out, const char *str)
+encode_ascii_string(struct di_string_builder *out, const char *str)
 {
 	size_t len = strlen(str);
 	size_t i;
@@ -101,28 +888,28 @@ di_info_get_make(const struct di_info *info)
 	const struct di_edid_vendor_product *evp;
 	char pnp_id[(sizeof(evp->manufacturer)) + 1] = { 0, };
 	const char *manuf;
-	struct memory_stream m;
+	struct di_string_builder sb;
 
 	if (!info->edid)
 		return NULL;
 
-	if (!memory_stream_open(&m))
-		return NULL;
+	/* The strings are always allocated with the C library */
+	_di_string_builder_init(&sb, NULL);
 
 	evp = di_edid_get_vendor_product(info->edid);
 	memcpy(pnp_id, evp->manufacturer, sizeof(evp->manufacturer));
 
 	manuf = pnp_id_table(pnp_id);
 	if (manuf) {
-		encode_ascii_string(m.fp, manuf);
-		return memory_stream_close(&m);
+		encode_ascii_string(&sb, manuf);
+		return _di_string_builder_finish(&sb);
 	}
 
-	fputs("PNP(", m.fp);
-	encode_ascii_string(m.fp, pnp_id);
-	fputs(")", m.fp);
+	_di_string_builder_append(&sb, "PNP(", 4);
+	encode_ascii_string(&sb, pnp_id);
+	_di_string_builder_append_char(&sb, ')');
 
-	return memory_stream_close(&m);
+	return _di_string_builder_finish(&sb);
 }
 
 char *
@@ -130,27 +917,26 @@ di_info_get_model(const struct di_info *info)
 {
 	const struct di_edid_vendor_product *evp;
 	const struct di_edid_display_descriptor *const *desc;
-	struct memory_stream m;
+	struct di_string_builder sb;
 	size_t i;
 
 	if (!info->edid)
 		return NULL;
 
-	if (!memory_stream_open(&m))
-		return NULL;
+	_di_string_builder_init(&sb, NULL);
 
 	desc = di_edid_get_display_descriptors(info->edid);
 	for (i = 0; desc[i]; i++) {
 		if (di_edid_display_descriptor_get_tag(desc[i]) == DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_NAME) {
-			encode_ascii_string(m.fp, di_edid_display_descriptor_get_string(desc[i]));
-			return memory_stream_close(&m);
+			encode_ascii_string(&sb, di_edid_display_descriptor_get_string(desc[i]));
+			return _di_string_builder_finish(&sb);
 		}
 	}
 
 	evp = di_edid_get_vendor_product(info->edid);
-	fprintf(m.fp, "0x%04" PRIX16, evp->product);
+	_di_string_builder_printf(&sb, "0x%04" PRIX16, evp->product);
 
-	return memory_stream_close(&m);
+	return _di_string_builder_finish(&sb);
 }
 
 char *
@@ -158,29 +944,27 @@ di_info_get_serial(const struct di_info *info)
 {
 	const struct di_edid_display_descriptor *const *desc;
 	const struct di_edid_vendor_product *evp;
-	struct memory_stream m;
+	struct di_string_builder sb;
 	size_t i;
 
 	if (!info->edid)
 		return NULL;
 
-	if (!memory_stream_open(&m))
-		return NULL;
+	_di_string_builder_init(&sb, NULL);
 
 	desc = di_edid_get_display_descriptors(info->edid);
 	for (i = 0; desc[i]; i++) {
 		if (di_edid_display_descriptor_get_tag(desc[i]) == DI_EDID_DISPLAY_DESCRIPTOR_PRODUCT_SERIAL) {
-			encode_ascii_string(m.fp, di_edid_display_descriptor_get_string(desc[i]));
-			return memory_stream_close(&m);
+			encode_ascii_string(&sb, di_edid_display_descriptor_get_string(desc[i]));
+			return _di_string_builder_finish(&sb);
 		}
 	}
 
 	evp = di_edid_get_vendor_product(info->edid);
 	if (evp->serial != 0) {
-		fprintf(m.fp, "0x%08" PRIX32, evp->serial);
-		return memory_stream_close(&m);
+		_di_string_builder_printf(&sb, "0x%08" PRIX32, evp->serial);
+		return _di_string_builder_finish(&sb);
 	}
 
-	free(memory_stream_close(&m));
 	return NULL;
 }
@@ -1,17 +1,550 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libdisplay-info/displayid.h>
+
+#include "allocator.h"
 #include "log.h"
 
-void
-_di_logger_va_add_failure(struct di_logger *logger, const char fmt[], va_list args)
+static bool
+buffer_grow(struct di_log_buffer *buf, size_t min_size)
+{
+	size_t size;
+	char *data;
+
+	size = buf->size > 0 ? buf->size : 256;
+	while (size < min_size)
+		size *= 2;
+
+	data = _di_realloc(buf->allocator, buf->data, buf->size, size);
+	if (!data)
+		return false;
+
+	buf->data = data;
+	buf->size = size;
+	return true;
+}
+
+static void
+buffer_va_printf(struct di_log_buffer *buf, const char fmt[], va_list args)
+{
+	va_list args_copy;
+	size_t avail;
+	int ret;
+
+	avail = buf->size - buf->len;
+	va_copy(args_copy, args);
+	ret = vsnprintf(avail > 0 ? &buf->data[buf->len] : NULL, avail,
+			fmt, args_copy);
+	va_end(args_copy);
+	if (ret < 0)
+		return;
+
+	if ((size_t) ret >= avail && buf->can_grow &&
+	    buffer_grow(buf, buf->len + (size_t) ret + 1)) {
+		avail = buf->size - buf->len;
+		vsnprintf(&buf->data[buf->len], avail, fmt, args);
+	}
+
+	buf->len += (size_t) ret;
+	if (buf->len >= buf->size)
+		buf->len = buf->size > 0 ? buf->size - 1 : 0;
+}
+
+static void
+buffer_append(struct di_log_buffer *buf, const char *str, size_t len)
+{
+	size_t avail;
+
+	if (buf->size - buf->len <= len && buf->can_grow)
+		buffer_grow(buf, buf->len + len + 1);
+
+	avail = buf->size - buf->len;
+	if (avail == 0)
+		return;
+	if (len >= avail)
+		len = avail - 1;
+
+	memcpy(&buf->data[buf->len], str, len);
+	buf->len += len;
+	buf->data[buf->len] = '\0';
+}
+
+static void
+buffer_append_str(struct di_log_buffer *buf, const char *str)
+{
+	buffer_append(buf, str, strlen(str));
+}
+
+static void
+buffer_printf(struct di_log_buffer *buf, const char fmt[], ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	buffer_va_printf(buf, fmt, args);
+	va_end(args);
+}
+
+static inline const char *
+get_displayid_data_block_name(uintmax_t tag)
+{
+	switch (tag) {
+	case DI_DISPLAYID_DATA_BLOCK_DISPLAY_PARAMS:
+		return "Display Parameters Data Block";
+	case DI_DISPLAYID_DATA_BLOCK_TYPE_I_TIMING:
+		return "Video Timing Modes Type 1 - Detailed Timings Data Block";
+	default:
+		return "Data Block";
+	}
+}
+
+/*
+ * Failures which aren't built in never reach the formatter: skip their case so
+ * that the message is compiled away with the code logging it.
+ */
+#define FAILURE_CASE(code) \
+	case code: \
+		if (!DI_FAILURE_ENABLED(code)) \
+			break;
+
+/**
+ * Format the message of a failure. The meaning of the arguments is specific
+ * to each failure code.
+ */
+static void
+format_failure(struct di_log_buffer *buf, enum di_failure_code code,
+	       const uintmax_t args[static_array DI_LOG_MAX_ARGS])
+{
+	const char *msg = NULL;
+
+	switch (code) {
+	FAILURE_CASE(DI_FAILURE_EDID_RESERVED_YEAR)
+		msg = "Year set to reserved value.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_INVALID_WEEK)
+		buffer_printf(buf, "Invalid week %ju of manufacture.", args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RESERVED_VIDEO_INTERFACE)
+		buffer_printf(buf, "Digital Video Interface Standard set to reserved value 0x%02jx.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RESERVED_COLOR_BIT_DEPTH)
+		msg = "Color Bit Depth set to reserved value.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_PARTIAL_PRIMARIES)
+		msg = "Some but not all primaries coordinates are unset.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_UNSET_WHITE_POINT)
+		msg = "White-point coordinates are unset.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_INVALID_STANDARD_TIMING_CODE)
+		buffer_printf(buf, "Use 0x0101 as the invalid Standard Timings code, not 0x%02jx%02jx.",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RESERVED_RANGE_OFFSET_FLAGS)
+		buffer_printf(buf, "Range offset flags set to reserved value 0x%02jx.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_RESERVED_OFFSET_BITS)
+		msg = "Display Range Limits: Bits 7:4 of the range offset flags are reserved.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_OFFSET)
+		msg = "Display Range Limits: Range offset flags are unsupported in EDID 1.3.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_RESERVED)
+		msg = "Display Range Limits: Range limits set to reserved values.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_VERT_RATE_ORDER)
+		msg = "Display Range Limits: Min vertical rate > max vertical rate.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_HORIZ_FREQ_ORDER)
+		msg = "Display Range Limits: Min horizontal freq > max horizontal freq.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_NO_MAX_DOTCLOCK)
+		msg = "Display Range Limits: EDID 1.4 block does not set max dotclock.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_BARE_LIMITS)
+		msg = "Display Range Limits: 'Bare Limits' is not allowed for EDID < 1.4.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_UNSUPPORTED_CVT)
+		msg = "Display Range Limits: 'CVT' is not allowed for EDID < 1.4.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_UNKNOWN_CLASS)
+		buffer_printf(buf, "Display Range Limits: Unknown range class (0x%02jx).",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_GTF_NON_CONTINUOUS)
+		msg = "Display Range Limits: GTF can't be combined with non-continuous frequencies.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_CVT_NON_CONTINUOUS)
+		msg = "Display Range Limits: CVT can't be combined with non-continuous frequencies.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_INVALID_BYTE_11)
+		/* Value, expected value */
+		buffer_printf(buf, "Display Range Limits: Byte 11 is 0x%02jx instead of 0x%02jx.",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_CVT_RESERVED_BITS)
+		/* Byte index */
+		buffer_printf(buf, "Display Range Limits: Reserved bits of byte %ju are non-zero.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_CVT_INVALID_ASPECT_RATIO)
+		buffer_printf(buf, "Display Range Limits: Invalid preferred aspect ratio 0x%02jx.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_CVT_NO_PREFERRED_REFRESH)
+		msg = "Display Range Limits: Preferred vertical refresh rate must be specified.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RANGE_LIMITS_INVALID_PADDING)
+		msg = "Display Range Limits: Bytes 12-17 must be 0x20.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_STANDARD_TIMINGS_NO_LINE_FEED)
+		msg = "Standard Timing Identifications: Last byte must be a line feed.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_UNSUPPORTED)
+		msg = "Established timings III: Not allowed for EDID < 1.4.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_ESTABLISHED_TIMINGS_III_RESERVED_BITS)
+		msg = "Established timings III: Reserved bits must be set to zero.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_RESERVED_WHITE_POINT_INDEX)
+		msg = "White Point Index Number set to reserved value 0";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_INVALID_COLOR_MANAGEMENT_VERSION)
+		msg = "Color Management Data version must be 3";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_INVALID_DESCRIPTOR_ORDERING)
+		msg = "Invalid detailed timing descriptor ordering.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_NO_PREFERRED_TIMING)
+		msg = "The first byte descriptor must contain the preferred timing.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_UNKNOWN_DISPLAY_DESCRIPTOR)
+		buffer_printf(buf, "Unknown Type 0x%02jx.", args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_UNKNOWN_EXTENSION)
+		msg = "Unknown Extension Block.";
+		break;
+	FAILURE_CASE(DI_FAILURE_EDID_EXTENSION_DECODE_FAILED)
+		/* Block index, errno */
+		buffer_printf(buf, "Block %ju: Failed to decode the extension block (errno %ju).",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_VIDEO_EMPTY)
+		msg = "Video Data Block: Empty Data Block";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_VIDEO_UNKNOWN_VIC)
+		buffer_printf(buf, "Video Data Block: Unknown VIC %ju.", args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_VIDEO_CAP_EMPTY)
+		buffer_printf(buf, "Video Capability Data Block: Empty Data Block with length %ju.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_VIDEO_CAP_NO_SELECTABLE_RGB_QUANT)
+		msg = "Video Capability Data Block: Set Selectable RGB Quantization to avoid interop issues.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_VIDEO_CAP_IT_SCAN_MISMATCH)
+		/* Whether the CTA-861 header sets IT video formats to
+		 * underscanned */
+		if (args[0])
+			msg = "Video Capability Data Block: IT video formats are always overscanned, but bit 7 of Byte 3 of the CTA-861 Extension header is set to underscanned.";
+		else
+			msg = "Video Capability Data Block: IT video formats are always underscanned, but bit 7 of Byte 3 of the CTA-861 Extension header is set to overscanned.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_COLORIMETRY_EMPTY)
+		buffer_printf(buf, "Colorimetry Data Block: Empty Data Block with length %ju.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_COLORIMETRY_RESERVED_BITS)
+		msg = "Colorimetry Data Block: Reserved bits MD0-MD3 must be 0.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_HDR_STATIC_METADATA_EMPTY)
+		buffer_printf(buf, "HDR Static Metadata Data Block: Empty Data Block with length %ju.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_EOTF)
+		msg = "HDR Static Metadata Data Block: Unknown EOTF.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_HDR_STATIC_METADATA_UNKNOWN_DESCRIPTOR)
+		msg = "HDR Static Metadata Data Block: Unknown descriptor type.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_HDR_STATIC_METADATA_MIN_WITHOUT_MAX)
+		msg = "HDR Static Metadata Data Block: Desired content min luminance is set, but max luminance is unset.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_INVALID_DATA_BLOCK_LENGTH)
+		buffer_printf(buf, "Invalid length %ju.", args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_EMPTY_EXTENDED_DATA_BLOCK)
+		msg = "Empty block with extended tag.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_UNKNOWN_EXTENDED_DATA_BLOCK)
+		buffer_printf(buf, "Unknown CTA-861 Data Block (extended tag 0x%02jx, length %ju).",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_UNKNOWN_DATA_BLOCK)
+		buffer_printf(buf, "Unknown CTA-861 Data Block (tag 0x%02jx, length %ju).",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_NON_ZERO_BYTE_3)
+		msg = "Non-zero byte 3.";
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_INVALID_DTD_OFFSET)
+		buffer_printf(buf, "Offset is %ju, but should be %ju.",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_CTA_NON_ZERO_PADDING)
+		msg = "Padding: Contains non-zero bytes.";
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_UNEXPECTED_REVISION)
+		/* Data block tag, revision, max revision */
+		buffer_printf(buf, "%s: Unexpected revision (%ju != %ju).",
+			      get_displayid_data_block_name(args[0]),
+			      args[1], args[2]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_UNEXPECTED_FLAGS)
+		/* Data block tag, flags */
+		buffer_printf(buf, "%s: Unexpected flags (0x%02jx).",
+			      get_displayid_data_block_name(args[0]), args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_DISPLAY_PARAMS_INVALID_LENGTH)
+		buffer_printf(buf, "Display Parameters Data Block: DisplayID payload length is different than expected (%ju != 15)",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_TYPE_I_TIMING_RESERVED_STEREO)
+		buffer_printf(buf, "Video Timing Modes Type 1 - Detailed Timings Data Block: Reserved stereo 0x%02jx.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_TYPE_I_TIMING_UNKNOWN_ASPECT)
+		buffer_printf(buf, "Video Timing Modes Type 1 - Detailed Timings Data Block: Unknown aspect 0x%02jx.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_TYPE_I_TIMING_INVALID_SIZE)
+		msg = "Video Timing Modes Type 1 - Detailed Timings Data Block: payload size not divisible by element size.";
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_DATA_BLOCK_OVERFLOW)
+		buffer_printf(buf, "The length of this DisplayID data block (%ju) exceeds the number of bytes remaining (%ju)",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_UNKNOWN_DATA_BLOCK)
+		buffer_printf(buf, "Unknown DisplayID Data Block (0x%jx, length %ju)",
+			      args[0], args[1]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_NON_ZERO_FILLER)
+		buffer_printf(buf, "Not enough bytes remain (%ju) for a DisplayID data block and the DisplayID filler is non-0.",
+			      args[0]);
+		break;
+	FAILURE_CASE(DI_FAILURE_DISPLAYID_NON_ZERO_PADDING)
+		msg = "Padding: Contains non-zero bytes.";
+		break;
+	}
+
+	if (msg)
+		buffer_append_str(buf, msg);
+}
+
+static void
+buffer_add_failure(struct di_logger *logger, enum di_failure_code code,
+		   const uintmax_t args[static_array DI_LOG_MAX_ARGS])
 {
 	if (!logger->initialized) {
-		if (ftell(logger->f) > 0) {
-			fprintf(logger->f, "\n");
+		if (logger->buf->len > 0) {
+			buffer_append_str(logger->buf, "\n");
 		}
-		fprintf(logger->f, "%s:\n", logger->section);
+		buffer_printf(logger->buf, "Block %zu, %s:\n", logger->block_index,
+			      logger->section);
 		logger->initialized = true;
 	}
 
-	fprintf(logger->f, "  ");
-	vfprintf(logger->f, fmt, args);
-	fprintf(logger->f, "\n");
+	buffer_append_str(logger->buf, "  ");
+	format_failure(logger->buf, code, args);
+	buffer_append_str(logger->buf, "\n");
+}
+
+void
+_di_log_buffer_add_section(struct di_log_buffer *buf, const char *section,
+			   size_t len)
+{
+	if (buf->len > 0) {
+		buffer_append_str(buf, "\n");
+	}
+	buffer_append(buf, section, len);
+}
+
+static struct di_log_record *
+records_add(struct di_log_records *records)
+{
+	struct di_log_record *data;
+	size_t cap;
+
+	if (records->len == records->cap) {
+		cap = records->cap > 0 ? records->cap * 2 : 4;
+		data = _di_realloc(records->allocator, records->data,
+				   records->cap * sizeof(*data),
+				   cap * sizeof(*data));
+		if (!data)
+			return NULL;
+		records->data = data;
+		records->cap = cap;
+	}
+
+	return &records->data[records->len++];
+}
+
+static void
+records_add_failure(struct di_logger *logger, enum di_failure_code code,
+		    const uintmax_t args[static_array DI_LOG_MAX_ARGS])
+{
+	struct di_log_record *record;
+
+	record = records_add(logger->records);
+	if (!record)
+		return;
+
+	*record = (struct di_log_record) {
+		.code = code,
+		.block_index = logger->block_index,
+		.section = logger->section,
+		.new_section = !logger->initialized,
+	};
+	memcpy(record->args, args, sizeof(record->args));
+	logger->initialized = true;
+}
+
+void
+_di_log_records_format(const struct di_log_records *records,
+		       struct di_log_buffer *buf)
+{
+	const struct di_log_record *record;
+	size_t i;
+
+	for (i = 0; i < records->len; i++) {
+		record = &records->data[i];
+		if (record->new_section) {
+			if (buf->len > 0) {
+				buffer_append_str(buf, "\n");
+			}
+			buffer_printf(buf, "Block %zu, %s:\n",
+				      record->block_index, record->section);
+		}
+
+		buffer_append_str(buf, "  ");
+		format_failure(buf, record->code, record->args);
+		buffer_append_str(buf, "\n");
+	}
+}
+
+bool
+_di_log_records_add_section(struct di_log_records *records,
+			    const struct di_log_records *src, size_t start,
+			    size_t len)
+{
+	struct di_log_record *record;
+	size_t i, prev_len = records->len;
+
+	for (i = start; i < start + len; i++) {
+		record = records_add(records);
+		if (!record) {
+			records->len = prev_len;
+			return false;
+		}
+		*record = src->data[i];
+	}
+
+	return true;
+}
+
+void
+_di_log_records_finish(struct di_log_records *records)
+{
+	_di_free(records->allocator, records->data);
+	*records = (struct di_log_records) {0};
+}
+
+bool
+_di_failure_list_reserve(struct di_failure_list *failures, size_t len)
+{
+	struct di_failure *data;
+	size_t cap;
+
+	if (!failures->can_grow || failures->cap - failures->len >= len)
+		return true;
+
+	cap = failures->cap > 0 ? failures->cap : 4;
+	while (cap - failures->len < len)
+		cap *= 2;
+	data = _di_realloc(failures->allocator, failures->data,
+			   failures->cap * sizeof(*data), cap * sizeof(*data));
+	if (!data)
+		return false;
+	failures->data = data;
+	failures->cap = cap;
+	return true;
+}
+
+static void
+failure_list_add(struct di_failure_list *failures, enum di_failure_code code,
+		 size_t block_index)
+{
+	if (!_di_failure_list_reserve(failures, 1) ||
+	    failures->len == failures->cap)
+		return;
+
+	failures->data[failures->len++] = (struct di_failure) {
+		.code = code,
+		.block_index = block_index,
+	};
+}
+
+void
+_di_failure_list_add_section(struct di_failure_list *failures,
+			     const struct di_failure_list *src, size_t start,
+			     size_t len)
+{
+	size_t i;
+
+	for (i = start; i < start + len; i++)
+		failure_list_add(failures, src->data[i].code,
+				 src->data[i].block_index);
+}
+
+void
+_di_failure_list_finish(struct di_failure_list *failures)
+{
+	_di_free(failures->allocator, failures->data);
+	*failures = (struct di_failure_list) {0};
+}
+
+void
+_di_logger_add_failure(struct di_logger *logger, enum di_failure_code code,
+		       const uintmax_t args[static_array DI_LOG_MAX_ARGS])
+{
+	if (di_failure_code_get_severity(code) < logger->min_severity)
+		return;
+
+	if (logger->failure_count)
+		(*logger->failure_count)++;
+	if (logger->failures)
+		failure_list_add(logger->failures, code, logger->block_index);
+
+	if (logger->buf)
+		buffer_add_failure(logger, code, args);
+	else if (logger->records)
+		records_add_failure(logger, code, args);
+}
+
+#define FAILURE_SEVERITY(code, severity) \
+	case code: \
+		return DI_FAILURE_SEVERITY_##severity;
+
+enum di_failure_severity
+di_failure_code_get_severity(enum di_failure_code code)
+{
+	switch (code) {
+	DI_FAILURE_SEVERITIES(FAILURE_SEVERITY)
+	}
+	return DI_FAILURE_SEVERITY_ERROR;
 }
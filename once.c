@@ -0,0 +1,36 @@
+#include "once.h"
+
+enum di_once_state {
+	DI_ONCE_INIT = 0,
+	DI_ONCE_RUNNING,
+	DI_ONCE_DONE,
+};
+
+bool
+_di_once_enter(struct di_once *once)
+{
+	int state;
+
+	state = atomic_load_explicit(&once->state, memory_order_acquire);
+	if (state == DI_ONCE_DONE)
+		return false;
+
+	state = DI_ONCE_INIT;
+	if (atomic_compare_exchange_strong_explicit(&once->state, &state,
+						    DI_ONCE_RUNNING,
+						    memory_order_acquire,
+						    memory_order_acquire))
+		return true;
+
+	/* Initializers are short and never block, spinning is fine */
+	while (atomic_load_explicit(&once->state, memory_order_acquire) != DI_ONCE_DONE)
+		continue;
+
+	return false;
+}
+
+void
+_di_once_leave(struct di_once *once)
+{
+	atomic_store_explicit(&once->state, DI_ONCE_DONE, memory_order_release);
+}
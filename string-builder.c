@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "string-builder.h"
+
+void
+_di_string_builder_init(struct di_string_builder *sb,
+			const struct di_allocator *allocator)
+{
+	sb->data = sb->inline_data;
+	sb->data[0] = '\0';
+	sb->len = 0;
+	sb->size = sizeof(sb->inline_data);
+	sb->failed = false;
+	sb->allocator = allocator;
+}
+
+static bool
+reserve(struct di_string_builder *sb, size_t len)
+{
+	size_t size;
+	char *data;
+
+	if (sb->failed)
+		return false;
+	if (sb->size - sb->len > len)
+		return true;
+
+	size = sb->size * 2;
+	while (size - sb->len <= len)
+		size *= 2;
+
+	if (sb->data == sb->inline_data) {
+		data = _di_malloc(sb->allocator, size);
+		if (data)
+			memcpy(data, sb->data, sb->len + 1);
+	} else {
+		data = _di_realloc(sb->allocator, sb->data, sb->size, size);
+	}
+	if (!data) {
+		sb->failed = true;
+		return false;
+	}
+
+	sb->data = data;
+	sb->size = size;
+	return true;
+}
+
+void
+_di_string_builder_append(struct di_string_builder *sb, const char *str,
+			  size_t len)
+{
+	if (!reserve(sb, len))
+		return;
+
+	memcpy(&sb->data[sb->len], str, len);
+	sb->len += len;
+	sb->data[sb->len] = '\0';
+}
+
+void
+_di_string_builder_append_char(struct di_string_builder *sb, char c)
+{
+	if (!reserve(sb, 1))
+		return;
+
+	sb->data[sb->len++] = c;
+	sb->data[sb->len] = '\0';
+}
+
+void
+_di_string_builder_va_printf(struct di_string_builder *sb, const char fmt[],
+			     va_list args)
+{
+	va_list args_copy;
+	int ret;
+
+	if (sb->failed)
+		return;
+
+	va_copy(args_copy, args);
+	ret = vsnprintf(&sb->data[sb->len], sb->size - sb->len, fmt, args_copy);
+	va_end(args_copy);
+	if (ret < 0) {
+		sb->data[sb->len] = '\0';
+		sb->failed = true;
+		return;
+	}
+
+	if ((size_t) ret >= sb->size - sb->len) {
+		if (!reserve(sb, (size_t) ret)) {
+			sb->data[sb->len] = '\0';
+			return;
+		}
+		vsnprintf(&sb->data[sb->len], sb->size - sb->len, fmt, args);
+	}
+
+	sb->len += (size_t) ret;
+}
+
+void
+_di_string_builder_printf(struct di_string_builder *sb, const char fmt[], ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	_di_string_builder_va_printf(sb, fmt, args);
+	va_end(args);
+}
+
+char *
+_di_string_builder_finish(struct di_string_builder *sb)
+{
+	char *str;
+
+	if (sb->failed) {
+		str = NULL;
+		if (sb->data != sb->inline_data)
+			_di_free(sb->allocator, sb->data);
+	} else if (sb->data == sb->inline_data) {
+		str = _di_malloc(sb->allocator, sb->len + 1);
+		if (str)
+			memcpy(str, sb->data, sb->len + 1);
+	} else {
+		str = sb->data;
+	}
+
+	_di_string_builder_init(sb, sb->allocator);
+	return str;
+}
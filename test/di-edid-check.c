@@ -0,0 +1,138 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <libdisplay-info/edid.h>
+#include <libdisplay-info/info.h>
+
+/* 128-byte EDID block */
+#define BLOCK_SIZE 128
+
+static size_t
+read_file(const char *path, uint8_t *raw, size_t raw_size)
+{
+	FILE *in;
+	size_t size = 0;
+
+	in = fopen(path, "r");
+	if (!in) {
+		perror("failed to open input file");
+		return 0;
+	}
+
+	while (!feof(in)) {
+		size += fread(&raw[size], 1, raw_size - size, in);
+		if (ferror(in)) {
+			perror("fread failed");
+			size = 0;
+			break;
+		} else if (size >= raw_size) {
+			fprintf(stderr, "input too large\n");
+			size = 0;
+			break;
+		}
+	}
+
+	fclose(in);
+	return size;
+}
+
+static size_t
+get_failure_count(const struct di_edid_check_result *result)
+{
+	return result->base_failures + result->cta_failures +
+	       result->displayid_failures;
+}
+
+/* Check a blob which can be decoded: the failures counted by di_edid_check()
+ * must be the ones reported by di_info_parse_edid() */
+static bool
+check_decodable(const char *path, const uint8_t *raw, size_t size)
+{
+	struct di_edid_check_result result;
+	struct di_info *info;
+	size_t failures_len;
+	bool conforms;
+
+	info = di_info_parse_edid(raw, size);
+	if (!info) {
+		perror("di_info_parse_edid failed");
+		return false;
+	}
+	di_info_get_failures(info, &failures_len);
+	di_info_destroy(info);
+
+	errno = 0;
+	conforms = di_edid_check(raw, size, 0, &result);
+	if (conforms != (failures_len == 0) ||
+	    (!conforms && errno != EPROTO)) {
+		fprintf(stderr, "%s: unexpected check result (errno %d)\n",
+			path, errno);
+		return false;
+	}
+	if (get_failure_count(&result) != failures_len) {
+		fprintf(stderr, "%s: %zu failures counted, %zu expected\n",
+			path, get_failure_count(&result), failures_len);
+		return false;
+	}
+
+	return true;
+}
+
+/* Check a blob which can't be decoded: di_edid_check() must fail like
+ * di_info_parse_edid(), without counting any failure */
+static bool
+check_undecodable(const char *path, const char *desc, const uint8_t *raw,
+		  size_t size)
+{
+	struct di_edid_check_result result;
+	struct di_info *info;
+	int parse_errno;
+
+	errno = 0;
+	info = di_info_parse_edid(raw, size);
+	parse_errno = errno;
+	if (info) {
+		fprintf(stderr, "%s: %s: di_info_parse_edid succeeded\n", path, desc);
+		di_info_destroy(info);
+		return false;
+	}
+
+	errno = 0;
+	if (di_edid_check(raw, size, 0, &result) || errno != parse_errno ||
+	    errno == EPROTO || get_failure_count(&result) != 0) {
+		fprintf(stderr, "%s: %s: unexpected check result (errno %d)\n",
+			path, desc, errno);
+		return false;
+	}
+
+	return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+	static uint8_t raw[32 * 1024];
+	size_t size;
+	int i, ret = 0;
+
+	for (i = 1; i < argc; i++) {
+		size = read_file(argv[i], raw, sizeof(raw));
+		if (size == 0)
+			return 1;
+
+		if (!check_decodable(argv[i], raw, size))
+			ret = 1;
+
+		if (!check_undecodable(argv[i], "truncated", raw, size - 1))
+			ret = 1;
+
+		raw[BLOCK_SIZE - 1]++;
+		if (!check_undecodable(argv[i], "bad checksum", raw, size))
+			ret = 1;
+	}
+
+	return ret;
+}
@@ -1,3 +1,4 @@
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -10,10 +11,26 @@ str_or_null(const char *str)
 	return str ? str : "{null}";
 }
 
+static const char *
+failure_severity_name(enum di_failure_severity severity)
+{
+	switch (severity) {
+	case DI_FAILURE_SEVERITY_PEDANTIC:
+		return "pedantic";
+	case DI_FAILURE_SEVERITY_WARNING:
+		return "warning";
+	case DI_FAILURE_SEVERITY_ERROR:
+		return "error";
+	}
+	return "unknown";
+}
+
 static void
 print_info(const struct di_info *info)
 {
 	char *str;
+	const struct di_failure *failures;
+	size_t failures_len, i;
 
 	str = di_info_get_make(info);
 	printf("make: %s\n", str_or_null(str));
@@ -26,6 +43,15 @@ print_info(const struct di_info *info)
 	str = di_info_get_serial(info);
 	printf("serial: %s\n", str_or_null(str));
 	free(str);
+
+	printf("fingerprint: 0x%016" PRIx64 "\n",
+	       di_info_get_fingerprint(info, 0));
+
+	failures = di_info_get_failures(info, &failures_len);
+	for (i = 0; i < failures_len; i++)
+		printf("failure: block %zu, code %d, %s\n",
+		       failures[i].block_index, (int) failures[i].code,
+		       failure_severity_name(di_failure_code_get_severity(failures[i].code)));
 }
 
 int
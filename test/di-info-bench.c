@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <libdisplay-info/info.h>
+
+#define ITERATIONS 10000
+
+static double
+get_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static size_t
+read_file(const char *path, uint8_t *raw, size_t raw_size)
+{
+	FILE *in;
+	size_t size = 0;
+
+	in = fopen(path, "r");
+	if (!in) {
+		perror("failed to open input file");
+		return 0;
+	}
+
+	while (!feof(in)) {
+		size += fread(&raw[size], 1, raw_size - size, in);
+		if (ferror(in)) {
+			perror("fread failed");
+			size = 0;
+			break;
+		} else if (size >= raw_size) {
+			fprintf(stderr, "input too large\n");
+			size = 0;
+			break;
+		}
+	}
+
+	fclose(in);
+	return size;
+}
+
+static void
+print_footprint(const char *name, const struct di_info_footprint *fp,
+		double parse_ns)
+{
+	printf("%-40s %8zu %8zu %8zu %8zu %8zu %8zu %10.0f\n", name,
+	       fp->base, fp->cta, fp->displayid, fp->failure_msg, fp->unused,
+	       fp->total, parse_ns);
+}
+
+int
+main(int argc, char *argv[])
+{
+	static uint8_t raw[32 * 1024];
+	size_t size;
+	struct di_info *info;
+	struct di_info_footprint fp, sum = {0};
+	struct di_parse_options options = {0};
+	double start, parse_ns, sum_ns = 0;
+	int first, i, j;
+
+	for (first = 1; first < argc; first++) {
+		if (strcmp(argv[first], "--exact-size") == 0)
+			options.exact_size = true;
+		else if (strcmp(argv[first], "--lazy") == 0)
+			options.lazy = true;
+		else if (strcmp(argv[first], "--skip-failure-msg") == 0)
+			options.skip |= DI_PARSE_SKIP_FAILURE_MSG;
+		else
+			break;
+	}
+
+	if (argc <= first) {
+		fprintf(stderr, "usage: di-info-bench [--exact-size] [--lazy] "
+			"[--skip-failure-msg] <edid>...\n");
+		return 1;
+	}
+
+	printf("%-40s %8s %8s %8s %8s %8s %8s %10s\n", "blob", "base", "cta",
+	       "displayid", "failures", "unused", "total", "ns/parse");
+
+	for (i = first; i < argc; i++) {
+		size = read_file(argv[i], raw, sizeof(raw));
+		if (size == 0)
+			return 1;
+
+		start = get_time_ns();
+		for (j = 0; j < ITERATIONS; j++) {
+			info = di_info_parse_edid_with_options(raw, size, &options);
+			if (!info) {
+				perror("di_info_parse_edid failed");
+				return 1;
+			}
+			di_info_destroy(info);
+		}
+		parse_ns = (get_time_ns() - start) / ITERATIONS;
+
+		info = di_info_parse_edid_with_options(raw, size, &options);
+		if (!info) {
+			perror("di_info_parse_edid failed");
+			return 1;
+		}
+		di_info_get_footprint(info, &fp);
+		di_info_destroy(info);
+
+		print_footprint(argv[i], &fp, parse_ns);
+
+		sum.base += fp.base;
+		sum.cta += fp.cta;
+		sum.displayid += fp.displayid;
+		sum.failure_msg += fp.failure_msg;
+		sum.unused += fp.unused;
+		sum.total += fp.total;
+		sum_ns += parse_ns;
+	}
+
+	print_footprint("total", &sum, sum_ns);
+
+	return 0;
+}
@@ -0,0 +1,180 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libdisplay-info/info.h>
+
+/* 128-byte EDID block */
+#define BLOCK_SIZE 128
+/* Delay between two blocks written to the pipe, like a slow DDC read */
+#define BLOCK_DELAY_NS (2 * 1000 * 1000)
+
+static size_t
+read_file(const char *path, uint8_t *raw, size_t raw_size)
+{
+	FILE *in;
+	size_t size = 0;
+
+	in = fopen(path, "r");
+	if (!in) {
+		perror("failed to open input file");
+		return 0;
+	}
+
+	while (!feof(in)) {
+		size += fread(&raw[size], 1, raw_size - size, in);
+		if (ferror(in)) {
+			perror("fread failed");
+			size = 0;
+			break;
+		} else if (size >= raw_size) {
+			fprintf(stderr, "input too large\n");
+			size = 0;
+			break;
+		}
+	}
+
+	fclose(in);
+	return size;
+}
+
+static void
+write_blocks(int fd, const uint8_t *raw, size_t size)
+{
+	struct timespec delay = { .tv_nsec = BLOCK_DELAY_NS };
+	size_t i;
+
+	for (i = 0; i < size; i += BLOCK_SIZE) {
+		nanosleep(&delay, NULL);
+		if (write(fd, &raw[i], BLOCK_SIZE) != BLOCK_SIZE) {
+			perror("write failed");
+			exit(1);
+		}
+	}
+}
+
+static bool
+read_block(int fd, uint8_t *block)
+{
+	size_t len = 0;
+	ssize_t n;
+
+	while (len < BLOCK_SIZE) {
+		n = read(fd, &block[len], BLOCK_SIZE - len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		len += (size_t) n;
+	}
+
+	return true;
+}
+
+static struct di_info *
+parse_from_pipe(const uint8_t *raw, size_t size)
+{
+	struct di_info_push_parser *parser;
+	uint8_t block[BLOCK_SIZE];
+	int fds[2], remaining, status;
+	pid_t pid;
+
+	if (pipe(fds) != 0) {
+		perror("pipe failed");
+		return NULL;
+	}
+
+	pid = fork();
+	if (pid < 0) {
+		perror("fork failed");
+		return NULL;
+	} else if (pid == 0) {
+		close(fds[0]);
+		write_blocks(fds[1], raw, size);
+		close(fds[1]);
+		exit(0);
+	}
+	close(fds[1]);
+
+	parser = di_info_push_parser_create(NULL);
+	if (!parser) {
+		perror("di_info_push_parser_create failed");
+		return NULL;
+	}
+
+	do {
+		if (!read_block(fds[0], block)) {
+			fprintf(stderr, "unexpected end of input\n");
+			break;
+		}
+		remaining = di_info_push_parser_push_block(parser, block);
+		if (remaining < 0) {
+			perror("di_info_push_parser_push_block failed");
+			break;
+		}
+	} while (remaining > 0);
+
+	close(fds[0]);
+	waitpid(pid, &status, 0);
+
+	return di_info_push_parser_finish(parser);
+}
+
+static bool
+str_equal(const char *a, const char *b)
+{
+	if (!a || !b)
+		return a == b;
+	return strcmp(a, b) == 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	static uint8_t raw[32 * 1024];
+	size_t size;
+	struct di_info *ref, *info;
+	char *ref_model, *model;
+	int i, ret = 0;
+
+	for (i = 1; i < argc; i++) {
+		size = read_file(argv[i], raw, sizeof(raw));
+		if (size == 0)
+			return 1;
+
+		ref = di_info_parse_edid(raw, size);
+		if (!ref) {
+			perror("di_info_parse_edid failed");
+			return 1;
+		}
+
+		info = parse_from_pipe(raw, size);
+		if (!info) {
+			perror("di_info_push_parser_finish failed");
+			return 1;
+		}
+
+		ref_model = di_info_get_model(ref);
+		model = di_info_get_model(info);
+		if (!str_equal(di_info_get_failure_msg(ref),
+			       di_info_get_failure_msg(info)) ||
+		    !str_equal(ref_model, model)) {
+			fprintf(stderr, "%s: push parser result differs\n", argv[i]);
+			ret = 1;
+		}
+
+		free(ref_model);
+		free(model);
+		di_info_destroy(info);
+		di_info_destroy(ref);
+	}
+
+	return ret;
+}
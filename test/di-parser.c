@@ -0,0 +1,170 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <libdisplay-info/info.h>
+
+/* Rounds over the input files before the parser is expected not to allocate
+ * anymore */
+#define WARMUP_ROUNDS 2
+#define MAX_FILES 64
+
+/* Number of calls to the allocator below */
+static size_t alloc_calls;
+
+static void *
+count_malloc(size_t size, void *user_data)
+{
+	alloc_calls++;
+	return malloc(size);
+}
+
+static void *
+count_calloc(size_t nmemb, size_t size, void *user_data)
+{
+	alloc_calls++;
+	return calloc(nmemb, size);
+}
+
+static void
+count_free(void *ptr, void *user_data)
+{
+	if (ptr)
+		alloc_calls++;
+	free(ptr);
+}
+
+static const struct di_allocator count_allocator = {
+	.malloc = count_malloc,
+	.calloc = count_calloc,
+	.free = count_free,
+};
+
+static size_t
+read_file(const char *path, uint8_t *raw, size_t raw_size)
+{
+	FILE *in;
+	size_t size = 0;
+
+	in = fopen(path, "r");
+	if (!in) {
+		perror("failed to open input file");
+		return 0;
+	}
+
+	while (!feof(in)) {
+		size += fread(&raw[size], 1, raw_size - size, in);
+		if (ferror(in)) {
+			perror("fread failed");
+			size = 0;
+			break;
+		} else if (size >= raw_size) {
+			fprintf(stderr, "input too large\n");
+			size = 0;
+			break;
+		}
+	}
+
+	fclose(in);
+	return size;
+}
+
+static bool
+str_equal(const char *a, const char *b)
+{
+	if (!a || !b)
+		return a == b;
+	return strcmp(a, b) == 0;
+}
+
+/* Parse a blob with the parser and check that the failures are the ones of a
+ * standalone parse, despite the recycled memory */
+static bool
+parse_and_check(struct di_parser *parser, const char *path,
+		const uint8_t *raw, size_t size, const char *ref_failure_msg,
+		size_t ref_failures_len)
+{
+	struct di_info *info;
+	size_t failures_len;
+	bool ok;
+
+	info = di_parser_parse_edid(parser, raw, size);
+	if (!info) {
+		perror("di_parser_parse_edid failed");
+		return false;
+	}
+
+	di_info_get_failures(info, &failures_len);
+	ok = str_equal(di_info_get_failure_msg(info), ref_failure_msg) &&
+	     failures_len == ref_failures_len;
+	if (!ok)
+		fprintf(stderr, "%s: parser result differs\n", path);
+
+	di_info_destroy(info);
+	return ok;
+}
+
+int
+main(int argc, char *argv[])
+{
+	static uint8_t raw[MAX_FILES][32 * 1024];
+	size_t sizes[MAX_FILES], failures_lens[MAX_FILES];
+	char *failure_msgs[MAX_FILES];
+	const char *msg;
+	struct di_parse_options options = { .allocator = &count_allocator };
+	struct di_parser *parser;
+	struct di_info *ref;
+	int files_len, round, i, ret = 0;
+
+	files_len = argc - 1;
+	if (files_len > MAX_FILES) {
+		fprintf(stderr, "too many input files\n");
+		return 1;
+	}
+
+	for (i = 0; i < files_len; i++) {
+		sizes[i] = read_file(argv[i + 1], raw[i], sizeof(raw[i]));
+		if (sizes[i] == 0)
+			return 1;
+
+		ref = di_info_parse_edid(raw[i], sizes[i]);
+		if (!ref) {
+			perror("di_info_parse_edid failed");
+			return 1;
+		}
+		msg = di_info_get_failure_msg(ref);
+		failure_msgs[i] = msg ? strdup(msg) : NULL;
+		di_info_get_failures(ref, &failures_lens[i]);
+		di_info_destroy(ref);
+	}
+
+	parser = di_parser_create_with_options(&options);
+	if (!parser) {
+		perror("di_parser_create_with_options failed");
+		return 1;
+	}
+
+	for (round = 0; round <= WARMUP_ROUNDS; round++) {
+		alloc_calls = 0;
+		for (i = 0; i < files_len; i++) {
+			if (!parse_and_check(parser, argv[i + 1], raw[i],
+					     sizes[i], failure_msgs[i],
+					     failures_lens[i]))
+				ret = 1;
+		}
+	}
+
+	/* The last round only reuses the memory recycled by the others */
+	if (alloc_calls > 0) {
+		fprintf(stderr, "%zu allocator calls in steady state\n",
+			alloc_calls);
+		ret = 1;
+	}
+
+	di_parser_destroy(parser);
+	for (i = 0; i < files_len; i++)
+		free(failure_msgs[i]);
+	return ret;
+}